@@ -0,0 +1,225 @@
+#include "ModCatalog.h"
+
+#include "Algo/BinarySearch.h"
+
+namespace ModCatalog
+{
+	static bool MatchesFlag(EModCatalogFlagFilter Filter, bool bFlag)
+	{
+		switch (Filter)
+		{
+		case EModCatalogFlagFilter::Only:
+			return bFlag;
+		case EModCatalogFlagFilter::Exclude:
+			return !bFlag;
+		default:
+			return true;
+		}
+	}
+
+	/** Uses an index to select the mods of a query if it is smaller than the one selected so far */
+	static void SelectIndex(const TArray<int32>& Index, const TArray<int32>*& InOutSelected)
+	{
+		if (InOutSelected == nullptr || Index.Num() < InOutSelected->Num())
+		{
+			InOutSelected = &Index;
+		}
+	}
+}
+
+void FModCatalog::Reset(TArray<FModInfo> InMods)
+{
+	Mods = MoveTemp(InMods);
+
+	// FString compares ignore case, so mods sharing a name prefix end up next to each other whatever its case
+	Mods.Sort([](const FModInfo& A, const FModInfo& B)
+	{
+		return A.Name < B.Name;
+	});
+
+	FriendlyNameOrder.Reset(Mods.Num());
+	NameIndex.Reset();
+	CategoryIndex.Reset();
+	CreatedByIndex.Reset();
+	BetaMods.Reset();
+	ExperimentalMods.Reset();
+	HiddenMods.Reset();
+
+	for (int32 ModIndex = 0; ModIndex < Mods.Num(); ++ModIndex)
+	{
+		const FModInfo& Mod = Mods[ModIndex];
+
+		FriendlyNameOrder.Add(ModIndex);
+		NameIndex.Add(Mod.Name, ModIndex);
+		CategoryIndex.FindOrAdd(Mod.Category).Add(ModIndex);
+		CreatedByIndex.FindOrAdd(Mod.CreatedBy).Add(ModIndex);
+
+		if (Mod.bIsBetaVersion)
+		{
+			BetaMods.Add(ModIndex);
+		}
+		if (Mod.bIsExperimentalVersion)
+		{
+			ExperimentalMods.Add(ModIndex);
+		}
+		if (Mod.bIsHidden)
+		{
+			HiddenMods.Add(ModIndex);
+		}
+	}
+
+	FriendlyNameOrder.Sort([this](int32 A, int32 B)
+	{
+		return Mods[A].FriendlyName < Mods[B].FriendlyName;
+	});
+}
+
+void FModCatalog::Query(const FModCatalogQuery& Query, FModCatalogPage& OutPage) const
+{
+	const int32 PageSize = FMath::Max(Query.PageSize, 1);
+	const int32 FirstMatch = FMath::Max(Query.PageIndex, 0) * PageSize;
+
+	OutPage.Mods.Reset();
+	OutPage.PageIndex = FMath::Max(Query.PageIndex, 0);
+	OutPage.TotalCount = 0;
+
+	ForEachMatch(Query, [this, &OutPage, FirstMatch, PageSize](int32 ModIndex)
+	{
+		if (OutPage.TotalCount >= FirstMatch && OutPage.Mods.Num() < PageSize)
+		{
+			OutPage.Mods.Add(Mods[ModIndex]);
+		}
+		++OutPage.TotalCount;
+	});
+
+	OutPage.NumPages = FMath::DivideAndRoundUp(OutPage.TotalCount, PageSize);
+}
+
+int32 FModCatalog::Count(const FModCatalogQuery& Query) const
+{
+	int32 NumMatches = 0;
+	ForEachMatch(Query, [&NumMatches](int32 ModIndex)
+	{
+		++NumMatches;
+	});
+
+	return NumMatches;
+}
+
+const FModInfo* FModCatalog::Find(const FString& Name) const
+{
+	const int32* ModIndex = NameIndex.Find(Name);
+	return ModIndex != nullptr ? &Mods[*ModIndex] : nullptr;
+}
+
+void FModCatalog::GetCategories(TArray<FString>& OutCategories) const
+{
+	CategoryIndex.GenerateKeyArray(OutCategories);
+	OutCategories.Sort();
+}
+
+void FModCatalog::GetAuthors(TArray<FString>& OutAuthors) const
+{
+	CreatedByIndex.GenerateKeyArray(OutAuthors);
+	OutAuthors.Sort();
+}
+
+void FModCatalog::ForEachMatch(const FModCatalogQuery& Query, TFunctionRef<void(int32)> Visitor) const
+{
+	static const TArray<int32> NoMods;
+
+	const TArray<int32>* Selected = nullptr;
+
+	if (!Query.Category.IsEmpty())
+	{
+		const TArray<int32>* Index = CategoryIndex.Find(Query.Category);
+		ModCatalog::SelectIndex(Index != nullptr ? *Index : NoMods, Selected);
+	}
+
+	if (!Query.CreatedBy.IsEmpty())
+	{
+		const TArray<int32>* Index = CreatedByIndex.Find(Query.CreatedBy);
+		ModCatalog::SelectIndex(Index != nullptr ? *Index : NoMods, Selected);
+	}
+
+	if (Query.Beta == EModCatalogFlagFilter::Only)
+	{
+		ModCatalog::SelectIndex(BetaMods, Selected);
+	}
+	if (Query.Experimental == EModCatalogFlagFilter::Only)
+	{
+		ModCatalog::SelectIndex(ExperimentalMods, Selected);
+	}
+	if (Query.Hidden == EModCatalogFlagFilter::Only)
+	{
+		ModCatalog::SelectIndex(HiddenMods, Selected);
+	}
+
+	TArray<int32> PrefixMods;
+	if (!Query.NamePrefix.IsEmpty() && (Selected == nullptr || Selected->Num() > 0))
+	{
+		FindByPrefix(Query.NamePrefix, PrefixMods);
+		ModCatalog::SelectIndex(PrefixMods, Selected);
+	}
+
+	auto Matches = [&Query](const FModInfo& Mod)
+	{
+		return (Query.Category.IsEmpty() || Mod.Category.Equals(Query.Category, ESearchCase::IgnoreCase))
+			&& (Query.CreatedBy.IsEmpty() || Mod.CreatedBy.Equals(Query.CreatedBy, ESearchCase::IgnoreCase))
+			&& (Query.NamePrefix.IsEmpty() || Mod.Name.StartsWith(Query.NamePrefix) || Mod.FriendlyName.StartsWith(Query.NamePrefix))
+			&& ModCatalog::MatchesFlag(Query.Beta, Mod.bIsBetaVersion)
+			&& ModCatalog::MatchesFlag(Query.Experimental, Mod.bIsExperimentalVersion)
+			&& ModCatalog::MatchesFlag(Query.Hidden, Mod.bIsHidden);
+	};
+
+	if (Selected != nullptr)
+	{
+		for (int32 ModIndex : *Selected)
+		{
+			if (Matches(Mods[ModIndex]))
+			{
+				Visitor(ModIndex);
+			}
+		}
+	}
+	else
+	{
+		for (int32 ModIndex = 0; ModIndex < Mods.Num(); ++ModIndex)
+		{
+			if (Matches(Mods[ModIndex]))
+			{
+				Visitor(ModIndex);
+			}
+		}
+	}
+}
+
+void FModCatalog::FindByPrefix(const FString& Prefix, TArray<int32>& OutModIndices) const
+{
+	OutModIndices.Reset();
+
+	// Names starting with the prefix sort right at or after the prefix itself
+	const int32 FirstByName = Algo::LowerBoundBy(Mods, Prefix, [](const FModInfo& Mod) -> const FString& { return Mod.Name; });
+	for (int32 ModIndex = FirstByName; ModIndex < Mods.Num() && Mods[ModIndex].Name.StartsWith(Prefix); ++ModIndex)
+	{
+		OutModIndices.Add(ModIndex);
+	}
+
+	const int32 NumByName = OutModIndices.Num();
+
+	const int32 FirstByFriendlyName = Algo::LowerBoundBy(FriendlyNameOrder, Prefix, [this](int32 ModIndex) -> const FString& { return Mods[ModIndex].FriendlyName; });
+	for (int32 Position = FirstByFriendlyName; Position < FriendlyNameOrder.Num() && Mods[FriendlyNameOrder[Position]].FriendlyName.StartsWith(Prefix); ++Position)
+	{
+		const int32 ModIndex = FriendlyNameOrder[Position];
+		if (!Mods[ModIndex].Name.StartsWith(Prefix))
+		{
+			OutModIndices.Add(ModIndex);
+		}
+	}
+
+	// Mods found by their friendly name aren't in name order
+	if (OutModIndices.Num() > NumByName)
+	{
+		OutModIndices.Sort();
+	}
+}
@@ -0,0 +1,102 @@
+#include "ModCatalogSubsystem.h"
+
+#include "ModManager.h"
+#include "ModSupport.h"
+
+void UModCatalogSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FModManager& ModManager = FModSupportModule::Get().GetModManager();
+
+	// Mounting fills in the mount information of a mod, so the catalog follows every mount as well as discovery
+	ModsDiscoveredHandle = ModManager.OnModsDiscovered().AddUObject(this, &UModCatalogSubsystem::MarkDirty);
+	ModMountedHandle = ModManager.OnModMounted().AddWeakLambda(this, [this](const FModInfo& ModInfo, bool bSuccess)
+	{
+		MarkDirty();
+	});
+	ModReloadedHandle = ModManager.OnModReloaded().AddWeakLambda(this, [this](const FModInfo& OldModInfo, const FModInfo& NewModInfo, bool bSuccess)
+	{
+		MarkDirty();
+	});
+}
+
+void UModCatalogSubsystem::Deinitialize()
+{
+	if (FModuleManager::Get().IsModuleLoaded(TEXT("ModSupport")))
+	{
+		FModManager& ModManager = FModSupportModule::Get().GetModManager();
+		ModManager.OnModsDiscovered().Remove(ModsDiscoveredHandle);
+		ModManager.OnModMounted().Remove(ModMountedHandle);
+		ModManager.OnModReloaded().Remove(ModReloadedHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+FModCatalogPage UModCatalogSubsystem::QueryMods(const FModCatalogQuery& Query) const
+{
+	FModCatalogPage Page;
+	GetCatalog().Query(Query, Page);
+	return Page;
+}
+
+int32 UModCatalogSubsystem::CountMods(const FModCatalogQuery& Query) const
+{
+	return GetCatalog().Count(Query);
+}
+
+bool UModCatalogSubsystem::FindMod(const FString& Name, FModInfo& OutModInfo) const
+{
+	if (const FModInfo* ModInfo = GetCatalog().Find(Name))
+	{
+		OutModInfo = *ModInfo;
+		return true;
+	}
+
+	return false;
+}
+
+TArray<FString> UModCatalogSubsystem::GetCategories() const
+{
+	TArray<FString> Categories;
+	GetCatalog().GetCategories(Categories);
+	return Categories;
+}
+
+TArray<FString> UModCatalogSubsystem::GetAuthors() const
+{
+	TArray<FString> Authors;
+	GetCatalog().GetAuthors(Authors);
+	return Authors;
+}
+
+int32 UModCatalogSubsystem::GetNumMods() const
+{
+	return GetCatalog().Num();
+}
+
+const FModCatalog& UModCatalogSubsystem::GetCatalog() const
+{
+	check(IsInGameThread());
+
+	if (bDirty)
+	{
+		TArray<FModInfo> Mods;
+		FModSupportModule::Get().GetModManager().GetMods(Mods);
+		Catalog.Reset(MoveTemp(Mods));
+		bDirty = false;
+	}
+
+	return Catalog;
+}
+
+void UModCatalogSubsystem::MarkDirty()
+{
+	// A whole batch of mods completing only notifies once, until the catalog was queried again
+	if (!bDirty)
+	{
+		bDirty = true;
+		OnCatalogChanged.Broadcast();
+	}
+}
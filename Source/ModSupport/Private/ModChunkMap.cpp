@@ -0,0 +1,74 @@
+#include "ModChunkMap.h"
+
+#include "ModSupportLog.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+FString FModChunkMap::GetPakFilename(const FString& ModName, const FString& ChunkName)
+{
+	return FString::Printf(TEXT("%s_%s.pak"), *ModName, *ChunkName);
+}
+
+bool FModChunkMap::Load(const FString& Filename)
+{
+	Chunks.Reset();
+
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *Filename))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to parse chunk map %s"), *Filename);
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& ChunkValue : RootObject->GetArrayField(TEXT("chunks")))
+	{
+		const TSharedPtr<FJsonObject>& ChunkObject = ChunkValue->AsObject();
+
+		FModChunk& Chunk = Chunks.AddDefaulted_GetRef();
+		Chunk.PakFile = ChunkObject->GetStringField(TEXT("pak"));
+		ChunkObject->TryGetStringArrayField(TEXT("packages"), Chunk.Packages);
+	}
+
+	return true;
+}
+
+bool FModChunkMap::Save(const FString& Filename) const
+{
+	TArray<TSharedPtr<FJsonValue>> ChunkValues;
+	for (const FModChunk& Chunk : Chunks)
+	{
+		TArray<TSharedPtr<FJsonValue>> Packages;
+		for (const FString& PackageName : Chunk.Packages)
+		{
+			Packages.Add(MakeShared<FJsonValueString>(PackageName));
+		}
+
+		TSharedRef<FJsonObject> ChunkObject = MakeShared<FJsonObject>();
+		ChunkObject->SetStringField(TEXT("pak"), Chunk.PakFile);
+		ChunkObject->SetArrayField(TEXT("packages"), Packages);
+
+		ChunkValues.Add(MakeShared<FJsonValueObject>(ChunkObject));
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetArrayField(TEXT("chunks"), ChunkValues);
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *Filename))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to save chunk map %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,95 @@
+#include "ModDependencyResolver.h"
+
+void FModDependencyResolver::AddMod(const FString& Name, const TArray<FString>& PluginsRequire)
+{
+	Dependencies.Add(Name, PluginsRequire);
+}
+
+bool FModDependencyResolver::Resolve(TFunctionRef<bool(const FString&)> IsPluginAvailable)
+{
+	Waves.Reset();
+	UnloadableMods.Reset();
+
+	// Number of dependencies on other added mods that have not been scheduled yet
+	TMap<FString, int32> PendingDependencyCounts;
+	TMap<FString, TArray<FString>> Dependents;
+
+	for (const TPair<FString, TArray<FString>>& Pair : Dependencies)
+	{
+		int32& PendingDependencyCount = PendingDependencyCounts.Add(Pair.Key, 0);
+
+		for (const FString& Dependency : Pair.Value)
+		{
+			if (Dependencies.Contains(Dependency))
+			{
+				Dependents.FindOrAdd(Dependency).Add(Pair.Key);
+				++PendingDependencyCount;
+			}
+			else if (!IsPluginAvailable(Dependency))
+			{
+				UnloadableMods.Add(Pair.Key, FString::Printf(TEXT("Missing dependency %s"), *Dependency));
+			}
+		}
+	}
+
+	TArray<FString> Ready;
+	for (const TPair<FString, int32>& Pair : PendingDependencyCounts)
+	{
+		if (Pair.Value == 0)
+		{
+			Ready.Add(Pair.Key);
+		}
+	}
+
+	while (Ready.Num() > 0)
+	{
+		TArray<FString> Wave;
+		TArray<FString> NextReady;
+
+		for (const FString& Name : Ready)
+		{
+			PendingDependencyCounts.Remove(Name);
+
+			const bool bLoadable = !UnloadableMods.Contains(Name);
+			if (bLoadable)
+			{
+				Wave.Add(Name);
+			}
+
+			if (const TArray<FString>* ModDependents = Dependents.Find(Name))
+			{
+				for (const FString& Dependent : *ModDependents)
+				{
+					if (!bLoadable && !UnloadableMods.Contains(Dependent))
+					{
+						UnloadableMods.Add(Dependent, FString::Printf(TEXT("Dependency %s cannot be loaded"), *Name));
+					}
+
+					if (--PendingDependencyCounts[Dependent] == 0)
+					{
+						NextReady.Add(Dependent);
+					}
+				}
+			}
+		}
+
+		if (Wave.Num() > 0)
+		{
+			Wave.Sort();
+			Waves.Add(MoveTemp(Wave));
+		}
+
+		Ready = MoveTemp(NextReady);
+	}
+
+	// Whatever was never ready is part of a dependency cycle, or depends on one
+	for (const TPair<FString, int32>& Pair : PendingDependencyCounts)
+	{
+		if (!UnloadableMods.Contains(Pair.Key))
+		{
+			UnloadableMods.Add(Pair.Key, TEXT("Part of or depends on a dependency cycle"));
+		}
+	}
+
+	return UnloadableMods.Num() == 0;
+}
@@ -1,3 +1,57 @@
 #include "ModInfo.h"
 
 #include "Interfaces/IPluginManager.h"
+#include "PluginDescriptor.h"
+
+void FModInfo::SetDescriptor(const FString& InName, const FPluginDescriptor& Descriptor)
+{
+	Name = InName;
+	Version = Descriptor.Version;
+	VersionName = Descriptor.VersionName;
+	FriendlyName = Descriptor.FriendlyName;
+	Description = Descriptor.Description;
+	Category = Descriptor.Category;
+	CreatedBy = Descriptor.CreatedBy;
+	CreatedByURL = Descriptor.CreatedByURL;
+	DocsURL = Descriptor.DocsURL;
+	MarketplaceURL = Descriptor.MarketplaceURL;
+	SupportURL = Descriptor.SupportURL;
+	EngineVersion = Descriptor.EngineVersion;
+	ParentPluginName = Descriptor.ParentPluginName;
+	bIsBetaVersion = Descriptor.bIsBetaVersion;
+	bIsExperimentalVersion = Descriptor.bIsExperimentalVersion;
+	bIsHidden = Descriptor.bIsHidden;
+
+	PluginsRequire.Reset(Descriptor.Plugins.Num());
+	for (const FPluginReferenceDescriptor& Plugin : Descriptor.Plugins)
+	{
+		if (Plugin.bEnabled)
+		{
+			PluginsRequire.Add(Plugin.Name);
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FModInfo& Info)
+{
+	Ar << Info.Name;
+	Ar << Info.ContentDir;
+	Ar << Info.VirtualMountPoint;
+	Ar << Info.Version;
+	Ar << Info.VersionName;
+	Ar << Info.FriendlyName;
+	Ar << Info.Description;
+	Ar << Info.Category;
+	Ar << Info.CreatedBy;
+	Ar << Info.CreatedByURL;
+	Ar << Info.DocsURL;
+	Ar << Info.MarketplaceURL;
+	Ar << Info.SupportURL;
+	Ar << Info.EngineVersion;
+	Ar << Info.ParentPluginName;
+	Ar << Info.bIsBetaVersion;
+	Ar << Info.bIsExperimentalVersion;
+	Ar << Info.bIsHidden;
+	Ar << Info.PluginsRequire;
+	return Ar;
+}
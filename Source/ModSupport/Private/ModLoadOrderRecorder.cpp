@@ -0,0 +1,90 @@
+#include "ModLoadOrderRecorder.h"
+
+#include "ModManager.h"
+#include "ModSupportLog.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeLock.h"
+
+FModLoadOrderRecorder::FModLoadOrderRecorder()
+{
+	SyncLoadPackageHandle = FCoreDelegates::OnSyncLoadPackage.AddRaw(this, &FModLoadOrderRecorder::HandlePackageLoad);
+	AsyncLoadPackageHandle = FCoreDelegates::OnAsyncLoadPackage.AddRaw(this, &FModLoadOrderRecorder::HandlePackageLoad);
+}
+
+FModLoadOrderRecorder::~FModLoadOrderRecorder()
+{
+	FCoreDelegates::OnSyncLoadPackage.Remove(SyncLoadPackageHandle);
+	FCoreDelegates::OnAsyncLoadPackage.Remove(AsyncLoadPackageHandle);
+}
+
+void FModLoadOrderRecorder::AddMod(const FString& ModName)
+{
+	FScopeLock Lock(&LoadOrdersCritical);
+	LoadOrders.FindOrAdd(ModName);
+}
+
+void FModLoadOrderRecorder::Save() const
+{
+	FScopeLock Lock(&LoadOrdersCritical);
+
+	for (const TPair<FString, TArray<FString>>& Pair : LoadOrders)
+	{
+		if (Pair.Value.Num() == 0)
+		{
+			continue;
+		}
+
+		const FString Filename = GetLoadOrderFilename(Pair.Key);
+
+		TArray<FString> LoadOrder;
+		FFileHelper::LoadFileToStringArray(LoadOrder, *Filename);
+
+		TSet<FString> ListedPackages(LoadOrder);
+		for (const FString& PackageName : Pair.Value)
+		{
+			if (!ListedPackages.Contains(PackageName))
+			{
+				LoadOrder.Add(PackageName);
+			}
+		}
+
+		if (!FFileHelper::SaveStringArrayToFile(LoadOrder, *Filename))
+		{
+			UE_LOG(LogModSupport, Warning, TEXT("Failed to save the load order of %s to %s"), *Pair.Key, *Filename);
+		}
+	}
+}
+
+FString FModLoadOrderRecorder::GetLoadOrderFilename(const FString& ModName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TEXT("LoadOrder.txt");
+}
+
+void FModLoadOrderRecorder::HandlePackageLoad(const FString& PackageName)
+{
+	FString Root;
+	if (!FModManager::GetMountPointRoot(PackageName, Root))
+	{
+		return;
+	}
+
+	FScopeLock Lock(&LoadOrdersCritical);
+
+	TArray<FString>* LoadOrder = LoadOrders.Find(Root);
+	if (LoadOrder == nullptr)
+	{
+		return;
+	}
+
+	// Loads may name an object rather than its package
+	const FString LongPackageName = FPackageName::ObjectPathToPackageName(PackageName);
+
+	bool bAlreadyLoaded = false;
+	LoadedPackages.Add(LongPackageName, &bAlreadyLoaded);
+	if (!bAlreadyLoaded)
+	{
+		LoadOrder->Add(LongPackageName);
+	}
+}
@@ -0,0 +1,1678 @@
+#include "ModManager.h"
+
+#include "ModDependencyResolver.h"
+#include "ModLoadOrderRecorder.h"
+#include "ModManifestCache.h"
+#include "ModPakDelta.h"
+#include "ModPakManifest.h"
+#include "ModSharedContentMap.h"
+#include "ModSupportLog.h"
+#include "ModSupportSettings.h"
+#include "ModSupportStats.h"
+#include "AssetRegistryModule.h"
+#include "AssetRegistryState.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "IPlatformFilePak.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/PackageName.h"
+#include "UObject/CoreRedirects.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+#include "PluginDescriptor.h"
+#include "Serialization/MemoryReader.h"
+#include "ShaderCodeLibrary.h"
+
+DECLARE_CYCLE_STAT(TEXT("Discover Mods"), STAT_ModSupport_DiscoverMods, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Parse Mod Descriptor"), STAT_ModSupport_ParseDescriptor, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Verify Mod Paks"), STAT_ModSupport_VerifyPaks, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Mount Mod Paks"), STAT_ModSupport_MountPaks, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Register Mod Mount Point"), STAT_ModSupport_RegisterMountPoint, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Mount Mod On Demand"), STAT_ModSupport_MountOnDemand, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Mount Mod Chunk"), STAT_ModSupport_MountChunk, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Reload Mod"), STAT_ModSupport_ReloadMod, STATGROUP_ModSupport);
+DECLARE_CYCLE_STAT(TEXT("Measure Mod Memory"), STAT_ModSupport_MeasureMemory, STATGROUP_ModSupport);
+
+FModManager::FModManager()
+	: ManifestCacheFilename(GetDefaultManifestCacheFilename())
+	, PakPlatformFile(nullptr)
+	, PendingMounts(0)
+	, CurrentWaveMounts(0)
+	, bMemoryUsageDirty(true)
+{
+	if (GetDefault<UModSupportSettings>()->bRecordLoadOrder)
+	{
+		LoadOrderRecorder = MakeUnique<FModLoadOrderRecorder>();
+	}
+
+	const UModSupportSettings* Settings = GetDefault<UModSupportSettings>();
+	if (Settings->bEnableMemoryBudget)
+	{
+		// Package loads tell which mods are in use
+		BindPackageLoadDelegates();
+		MemoryBudgetTickHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FModManager::HandleMemoryBudgetTick), FMath::Max(Settings->MemoryBudgetCheckInterval, 1.0f));
+
+		// Collections free content of the mods, which is only measured again after something changed
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([this]()
+		{
+			FScopeLock Lock(&OnDemandCritical);
+			bMemoryUsageDirty = true;
+		});
+	}
+}
+
+FModManager::~FModManager()
+{
+	if (LoadOrderRecorder.IsValid())
+	{
+		LoadOrderRecorder->Save();
+	}
+
+	FCoreDelegates::OnSyncLoadPackage.Remove(SyncLoadPackageHandle);
+	FCoreDelegates::OnAsyncLoadPackage.Remove(AsyncLoadPackageHandle);
+
+	if (MemoryBudgetTickHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(MemoryBudgetTickHandle);
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	}
+
+	// The completion callbacks only hold a weak reference, but the worker tasks must not outlive the pak platform file users
+	for (TFuture<void>& Task : PendingTasks)
+	{
+		Task.Wait();
+	}
+
+	for (TPair<FString, TSharedFuture<bool>>& Pair : PakVerifications)
+	{
+		Pair.Value.Wait();
+	}
+
+	// Mods a loading thread is mounting on demand record their timings too, and only complete once their verification did
+	TArray<TSharedFuture<bool>> PendingOnDemandMounts;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+		OnDemandMounts.GenerateValueArray(PendingOnDemandMounts);
+	}
+
+	for (TSharedFuture<bool>& Mount : PendingOnDemandMounts)
+	{
+		Mount.Wait();
+	}
+}
+
+void FModManager::DiscoverMods()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_DiscoverMods);
+
+	struct FDescriptorFile
+	{
+		FString Filename;
+		FFileStatData StatData;
+	};
+
+	// Mods live in their own sub directory, so only the top level of each one has to be searched for a descriptor
+	TArray<FDescriptorFile> DescriptorFiles;
+
+	TArray<FString> ModDirs;
+	IFileManager::Get().IterateDirectory(*GetModsDir(), [&ModDirs](const TCHAR* Path, bool bIsDirectory)
+	{
+		if (bIsDirectory)
+		{
+			ModDirs.Add(Path);
+		}
+		return true;
+	});
+
+	for (const FString& ModDir : ModDirs)
+	{
+		IFileManager::Get().IterateDirectoryStat(*ModDir, [&DescriptorFiles](const TCHAR* Path, const FFileStatData& StatData)
+		{
+			if (!StatData.bIsDirectory && FPaths::GetExtension(Path) == TEXT("uplugin"))
+			{
+				DescriptorFiles.Add({ Path, StatData });
+			}
+			return true;
+		});
+	}
+
+	const bool bUseManifestCache = GetDefault<UModSupportSettings>()->bUseManifestCache;
+
+	FModManifestCache ManifestCache;
+	if (bUseManifestCache)
+	{
+		ManifestCache.Load(ManifestCacheFilename);
+	}
+
+	TArray<FModInfo> Infos;
+	Infos.SetNum(DescriptorFiles.Num());
+
+	TArray<int32> ChangedDescriptors;
+	TSet<FString> DescriptorFilenames;
+
+	for (int32 Index = 0; Index < DescriptorFiles.Num(); ++Index)
+	{
+		const FDescriptorFile& File = DescriptorFiles[Index];
+		DescriptorFilenames.Add(File.Filename);
+
+		if (const FModInfo* CachedInfo = ManifestCache.Find(File.Filename, File.StatData.FileSize, File.StatData.ModificationTime))
+		{
+			Infos[Index] = *CachedInfo;
+		}
+		else
+		{
+			ChangedDescriptors.Add(Index);
+		}
+	}
+
+	TArray<bool> ParseResults;
+	ParseResults.SetNumZeroed(ChangedDescriptors.Num());
+
+	ParallelFor(ChangedDescriptors.Num(), [&](int32 ChangedIndex)
+	{
+		const int32 Index = ChangedDescriptors[ChangedIndex];
+		const FString& Filename = DescriptorFiles[Index].Filename;
+		const FString ModName = FPaths::GetBaseFilename(Filename);
+
+		SCOPE_CYCLE_COUNTER(STAT_ModSupport_ParseDescriptor);
+		FModLoadPhaseScope PhaseScope(LoadTimings, ModName, EModLoadPhase::Discover);
+
+		FPluginDescriptor Descriptor;
+		FText FailReason;
+		if (Descriptor.Load(Filename, FailReason))
+		{
+			Infos[Index].SetDescriptor(ModName, Descriptor);
+			ParseResults[ChangedIndex] = true;
+		}
+		else
+		{
+			UE_LOG(LogModSupport, Error, TEXT("Failed to parse mod descriptor %s: %s"), *Filename, *FailReason.ToString());
+		}
+	});
+
+	for (int32 ChangedIndex = 0; ChangedIndex < ChangedDescriptors.Num(); ++ChangedIndex)
+	{
+		const FDescriptorFile& File = DescriptorFiles[ChangedDescriptors[ChangedIndex]];
+
+		if (ParseResults[ChangedIndex])
+		{
+			ManifestCache.Add(File.Filename, File.StatData.FileSize, File.StatData.ModificationTime, Infos[ChangedDescriptors[ChangedIndex]]);
+		}
+		else
+		{
+			// Keep the broken descriptor out of the cache so it is reported again on the next boot
+			DescriptorFilenames.Remove(File.Filename);
+		}
+	}
+
+	UE_LOG(LogModSupport, Log, TEXT("Found %d mod descriptor(s), %d parsed and %d read from the manifest cache"),
+		DescriptorFiles.Num(), ChangedDescriptors.Num(), DescriptorFiles.Num() - ChangedDescriptors.Num());
+
+	for (int32 Index = 0; Index < DescriptorFiles.Num(); ++Index)
+	{
+		if (!Infos[Index].Name.IsEmpty())
+		{
+			AddDiscoveredMod(Infos[Index], FPaths::GetPath(DescriptorFiles[Index].Filename), bUseManifestCache ? &ManifestCache : nullptr);
+		}
+	}
+
+	if (bUseManifestCache)
+	{
+		ManifestCache.RemoveAllExcept(DescriptorFilenames);
+
+		if (ManifestCache.IsDirty())
+		{
+			ManifestCache.Save(ManifestCacheFilename);
+		}
+	}
+
+	ModsDiscoveredEvent.Broadcast();
+}
+
+FString FModManager::GetModsDir()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectDir() / GetDefault<UModSupportSettings>()->ModsDirectory);
+}
+
+FString FModManager::GetDefaultManifestCacheFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModManifestCache.bin");
+}
+
+void FModManager::AddDiscoveredMod(const FModInfo& Info, const FString& BaseDir, FModManifestCache* ManifestCache)
+{
+	FModRecord& Record = Mods.FindOrAdd(Info.Name);
+	if (Record.State == EModState::Mounting || Record.State == EModState::Mounted)
+	{
+		return;
+	}
+
+	FModLoadPhaseScope PhaseScope(LoadTimings, Info.Name, EModLoadPhase::Discover);
+
+	Record.Info = Info;
+	Record.BaseDir = BaseDir;
+
+	const FString PakDir = BaseDir / TEXT("Content") / TEXT("Paks") / FPlatformProperties::PlatformName();
+
+	TArray<FString> FoundPaks;
+	IFileManager::Get().FindFiles(FoundPaks, *PakDir, TEXT("pak"));
+
+	// The pak manifest holds the block hashes of every pak, so only what discovery needs of it is cached with the descriptor
+	const FString DescriptorFilename = BaseDir / Info.Name + TEXT(".uplugin");
+	const FString PakManifestFilename = PakDir / FModPakManifest::GetFilename();
+	const FString ChunkMapFilename = PakDir / FModChunkMap::GetFilename();
+	const FDateTime PakManifestTimestamp = IFileManager::Get().GetTimeStamp(*PakManifestFilename);
+	const FDateTime ChunkMapTimestamp = IFileManager::Get().GetTimeStamp(*ChunkMapFilename);
+
+	FModPakDirInfo PakDirInfo;
+	if (const FModPakDirInfo* CachedPakDirInfo = ManifestCache != nullptr ? ManifestCache->FindPakDirInfo(DescriptorFilename, PakManifestTimestamp, ChunkMapTimestamp) : nullptr)
+	{
+		PakDirInfo = *CachedPakDirInfo;
+	}
+	else
+	{
+		FModPakManifest PakManifest;
+		if (PakManifestTimestamp != FDateTime::MinValue() && PakManifest.Load(PakManifestFilename))
+		{
+			PakDirInfo.bHasPakManifest = true;
+			PakManifest.Paks.GenerateKeyArray(PakDirInfo.ReleasePaks);
+		}
+
+		FModChunkMap ChunkMap;
+		if (ChunkMapTimestamp != FDateTime::MinValue() && ChunkMap.Load(ChunkMapFilename))
+		{
+			PakDirInfo.Chunks = MoveTemp(ChunkMap.Chunks);
+		}
+
+		if (ManifestCache != nullptr)
+		{
+			ManifestCache->AddPakDirInfo(DescriptorFilename, PakManifestTimestamp, ChunkMapTimestamp, PakDirInfo);
+		}
+	}
+
+	// The pak manifest lists every pak of the installed release. Patch paks left over from before a full package are
+	// missing from it, and would otherwise override the new base pak with their higher read order
+	if (PakDirInfo.bHasPakManifest)
+	{
+		FoundPaks.RemoveAll([&Info, &PakDirInfo](const FString& PakFile)
+		{
+			if (!PakDirInfo.ReleasePaks.Contains(PakFile))
+			{
+				UE_LOG(LogModSupport, Log, TEXT("Skipping %s of mod %s, it isn't part of the installed release"), *PakFile, *Info.Name);
+				return true;
+			}
+			return false;
+		});
+	}
+
+	Record.PakFiles.Reset(FoundPaks.Num());
+	for (const FString& PakFile : FoundPaks)
+	{
+		Record.PakFiles.Add(PakDir / PakFile);
+	}
+
+	// Optional chunks are mounted apart from the core of the mod
+	Record.OptionalChunks.Reset();
+
+	for (FModChunk& Chunk : PakDirInfo.Chunks)
+	{
+		Chunk.PakFile = PakDir / Chunk.PakFile;
+		if (Record.PakFiles.Remove(Chunk.PakFile) > 0)
+		{
+			Record.OptionalChunks.Add(MoveTemp(Chunk));
+		}
+	}
+
+	Record.State = EModState::Discovered;
+
+	UE_LOG(LogModSupport, Verbose, TEXT("Discovered mod %s with %d pak(s) and %d optional chunk(s)"), *Info.Name, Record.PakFiles.Num(), Record.OptionalChunks.Num());
+}
+
+void FModManager::ApplyPakDeltas(const FString& ModName, const FString& PakDir)
+{
+	TArray<FString> DeltaFiles;
+	IFileManager::Get().FindFiles(DeltaFiles, *PakDir, FModPakDelta::GetExtension());
+
+	for (const FString& DeltaFile : DeltaFiles)
+	{
+		// Foo.pak.moddelta updates Foo.pak
+		const FString PakFile = PakDir / FPaths::GetBaseFilename(DeltaFile);
+
+		FString Error;
+		if (FModPakDelta::Apply(PakFile, PakDir / DeltaFile, PakFile, Error))
+		{
+			UE_LOG(LogModSupport, Log, TEXT("Updated %s of mod %s from its delta"), *FPaths::GetCleanFilename(PakFile), *ModName);
+			IFileManager::Get().Delete(*(PakDir / DeltaFile));
+		}
+		else
+		{
+			// The old pak is left untouched, the mod keeps its previous version of the pak
+			UE_LOG(LogModSupport, Error, TEXT("Failed to update mod %s: %s"), *ModName, *Error);
+		}
+	}
+}
+
+void FModManager::MountModsAsync()
+{
+	check(IsInGameThread());
+
+	PakPlatformFile = GetPakPlatformFile();
+	if (PakPlatformFile == nullptr)
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to find or create the pak platform file, mods will not be mounted"));
+		return;
+	}
+
+	FModDependencyResolver Resolver;
+	for (const TPair<FString, FModRecord>& Pair : Mods)
+	{
+		if (Pair.Value.State == EModState::Discovered)
+		{
+			Resolver.AddMod(Pair.Key, Pair.Value.Info.PluginsRequire);
+		}
+	}
+
+	Resolver.Resolve([this](const FString& PluginName)
+	{
+		// Mods of a batch that is still mounting count as available, since their waves run first
+		const FModRecord* Record = Mods.Find(PluginName);
+		if (Record != nullptr)
+		{
+			return Record->State == EModState::Mounting || Record->State == EModState::Registered || Record->State == EModState::Mounted;
+		}
+
+		TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(PluginName);
+		return Plugin.IsValid() && Plugin->IsEnabled();
+	});
+
+	for (const TPair<FString, FString>& Pair : Resolver.GetUnloadableMods())
+	{
+		FModRecord& Record = Mods.FindChecked(Pair.Key);
+		Record.State = EModState::Failed;
+
+		UE_LOG(LogModSupport, Error, TEXT("Mod %s cannot be loaded: %s"), *Pair.Key, *Pair.Value);
+		ModMountedEvent.Broadcast(Record.Info, false);
+	}
+
+	// Registered mods are only updated and verified once they are first needed
+	if (GetDefault<UModSupportSettings>()->bMountOnDemand)
+	{
+		RegisterModsOnDemand(Resolver.GetWaves());
+		return;
+	}
+
+	// Every mod is verified right away, so later waves are usually verified by the time their dependencies mounted
+	TArray<FString> MountedPaks;
+	PakPlatformFile->GetMountedPakFilenames(MountedPaks);
+
+	for (const TArray<FString>& Wave : Resolver.GetWaves())
+	{
+		for (const FString& Name : Wave)
+		{
+			FModRecord& Record = Mods.FindChecked(Name);
+			Record.State = EModState::Mounting;
+
+			TSharedFuture<bool> PakVerification = StartPakVerification(Name, Record.PakFiles.FilterByPredicate([&MountedPaks](const FString& PakFile)
+			{
+				return !MountedPaks.Contains(PakFile);
+			}), LoadTimings);
+
+			if (PakVerification.IsValid())
+			{
+				PakVerifications.Add(Name, MoveTemp(PakVerification));
+			}
+		}
+
+		PendingMounts += Wave.Num();
+		PendingWaves.Add(Wave);
+	}
+
+	UE_LOG(LogModSupport, Log, TEXT("Mounting %d mod(s) in %d wave(s)"), PendingMounts, PendingWaves.Num());
+
+	if (PendingMounts == 0)
+	{
+		AllModsMountedEvent.Broadcast();
+	}
+	else if (CurrentWaveMounts == 0)
+	{
+		StartNextWave();
+	}
+}
+
+void FModManager::StartNextWave()
+{
+	check(CurrentWaveMounts == 0 && PendingWaves.Num() > 0);
+
+	TArray<FString> Wave = PendingWaves[0];
+	PendingWaves.RemoveAt(0);
+
+	CurrentWaveMounts = Wave.Num();
+
+	TArray<FString> MountedPaks;
+	PakPlatformFile->GetMountedPakFilenames(MountedPaks);
+
+	const int32 PakReadOrder = GetDefault<UModSupportSettings>()->PakReadOrder;
+
+	TArray<FString> ModsWithoutPaks;
+	TArray<FString> ModsWithFailedDependencies;
+
+	TWeakPtr<FModManager> WeakThis = AsShared();
+	FPakPlatformFile* PakPlatformFileForTask = PakPlatformFile;
+
+	// The destructor waits for all tasks, so they can safely record into the timings
+	FModLoadTimings* Timings = &LoadTimings;
+
+	for (const FString& Name : Wave)
+	{
+		const FModRecord& Record = Mods.FindChecked(Name);
+
+		const bool bDependencyFailed = Record.Info.PluginsRequire.ContainsByPredicate([this](const FString& Dependency)
+		{
+			const FModRecord* DependencyRecord = Mods.Find(Dependency);
+			return DependencyRecord != nullptr && DependencyRecord->State == EModState::Failed;
+		});
+
+		if (bDependencyFailed)
+		{
+			ModsWithFailedDependencies.Add(Name);
+			continue;
+		}
+
+		if (Record.OptionalChunks.Num() > 0)
+		{
+			FScopeLock Lock(&OnDemandCritical);
+			RegisterOptionalChunks_Locked(Record, MountedPaks, PakReadOrder);
+			BindPackageLoadDelegates();
+		}
+
+		TArray<FString> PaksToMount = Record.PakFiles.FilterByPredicate([&MountedPaks](const FString& PakFile)
+		{
+			return !MountedPaks.Contains(PakFile);
+		});
+
+		if (PaksToMount.Num() == 0)
+		{
+			// Loose content, or paks the engine already mounted for us
+			ModsWithoutPaks.Add(Name);
+			continue;
+		}
+
+		TSharedFuture<bool> PakVerification;
+		PakVerifications.RemoveAndCopyValue(Name, PakVerification);
+
+		PendingTasks.Add(Async(EAsyncExecution::ThreadPool, [WeakThis, Name, PaksToMount, PakPlatformFileForTask, PakReadOrder, Timings, PakVerification]()
+		{
+			// Only this mod's own verification is waited for, not that of the whole batch
+			const bool bVerified = !PakVerification.IsValid() || PakVerification.Get();
+			const bool bSuccess = bVerified && MountPaks(PakPlatformFileForTask, Name, PaksToMount, PakReadOrder, *Timings);
+
+			TArray<FName> PackageFilenames;
+			if (bSuccess)
+			{
+				ReadPackageFilenames(PaksToMount, PackageFilenames);
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Name, bSuccess, PackageFilenames = MoveTemp(PackageFilenames)]() mutable
+			{
+				if (TSharedPtr<FModManager> This = WeakThis.Pin())
+				{
+					This->IndexPackages(Name, MoveTemp(PackageFilenames));
+					This->HandleModMounted(Name, bSuccess);
+				}
+			});
+		}));
+	}
+
+	for (const FString& Name : ModsWithFailedDependencies)
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Mod %s cannot be loaded: a dependency failed to mount"), *Name);
+		HandleModMounted(Name, false);
+	}
+
+	for (const FString& Name : ModsWithoutPaks)
+	{
+		HandleModMounted(Name, true);
+	}
+}
+
+void FModManager::WaitForPendingMounts()
+{
+	check(IsInGameThread());
+
+	// Every completed wave starts the next one from its completion callbacks, which run on the game thread
+	while (PendingMounts > 0)
+	{
+		for (TFuture<void>& Task : PendingTasks)
+		{
+			Task.Wait();
+		}
+
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	}
+}
+
+bool FModManager::ReloadMod(const FString& Name)
+{
+	check(IsInGameThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_ReloadMod);
+
+	FModRecord* Record = Mods.Find(Name);
+	if (Record == nullptr || (Record->State != EModState::Mounted && Record->State != EModState::Registered))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Cannot reload mod %s, it isn't mounted"), *Name);
+		return false;
+	}
+
+	const FModInfo OldInfo = Record->Info;
+
+	FPluginDescriptor Descriptor;
+	FText FailReason;
+	if (!Descriptor.Load(Record->BaseDir / Name + TEXT(".uplugin"), FailReason))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Cannot reload mod %s: %s"), *Name, *FailReason.ToString());
+		return false;
+	}
+
+	FModInfo NewInfo;
+	NewInfo.SetDescriptor(Name, Descriptor);
+
+	UnloadModPackages(*Record);
+	UnmountMod(*Record);
+
+	AddDiscoveredMod(NewInfo, Record->BaseDir, nullptr);
+
+	TArray<FString> MountedPaks;
+	PakPlatformFile->GetMountedPakFilenames(MountedPaks);
+
+	const int32 PakReadOrder = GetDefault<UModSupportSettings>()->PakReadOrder;
+
+	if (Record->OptionalChunks.Num() > 0)
+	{
+		FScopeLock Lock(&OnDemandCritical);
+		RegisterOptionalChunks_Locked(*Record, MountedPaks, PakReadOrder);
+		BindPackageLoadDelegates();
+	}
+
+	// The mod was in use, so it is mounted right away even in on-demand mode. Reloading is synchronous, so its
+	// deltas are applied right here, which is what a reload after installing an update is for
+	Record->State = EModState::Mounting;
+	if (Record->PakFiles.Num() > 0)
+	{
+		ApplyPakDeltas(Name, FPaths::GetPath(Record->PakFiles[0]));
+	}
+	const bool bVerified = !GetDefault<UModSupportSettings>()->bVerifyPaks || VerifyPaks(Name, Record->PakFiles, LoadTimings);
+	const bool bSuccess = bVerified && MountPaks(PakPlatformFile, Name, Record->PakFiles, PakReadOrder, LoadTimings);
+
+	if (bSuccess)
+	{
+		TArray<FName> PackageFilenames;
+		ReadPackageFilenames(Record->PakFiles, PackageFilenames);
+		IndexPackages(Name, MoveTemp(PackageFilenames));
+	}
+
+	CompleteMount(Name, bSuccess);
+
+	UE_LOG(LogModSupport, Log, TEXT("Reloaded mod %s: version %d (%s) -> %d (%s)"),
+		*Name, OldInfo.Version, *OldInfo.VersionName, Record->Info.Version, *Record->Info.VersionName);
+
+	ModReloadedEvent.Broadcast(OldInfo, Record->Info, bSuccess);
+	return bSuccess;
+}
+
+void FModManager::UnmountMods()
+{
+	check(IsInGameThread());
+
+	WaitForPendingMounts();
+
+	for (TPair<FString, FModRecord>& Pair : Mods)
+	{
+		if (Pair.Value.State == EModState::Mounted || Pair.Value.State == EModState::Registered)
+		{
+			UnloadModPackages(Pair.Value);
+			UnmountMod(Pair.Value);
+		}
+	}
+}
+
+void FModManager::UnloadModPackages(const FModRecord& Record)
+{
+	// Packages still loading would be loaded from the paks about to be unmounted
+	if (IsAsyncLoading())
+	{
+		FlushAsyncLoading();
+	}
+
+	// The pak index lists exactly the files of the mod, so the loaded packages are found without walking every object
+	TArray<UPackage*> LoadedPackages;
+	IFileManager::Get().IterateDirectoryRecursively(*Record.Info.ContentDir, [&LoadedPackages](const TCHAR* Filename, bool bIsDirectory)
+	{
+		FString PackageName;
+		if (!bIsDirectory && FPackageName::IsPackageFilename(Filename) && FPackageName::TryConvertFilenameToLongPackageName(Filename, PackageName))
+		{
+			if (UPackage* Package = FindObjectFast<UPackage>(nullptr, FName(*PackageName)))
+			{
+				LoadedPackages.Add(Package);
+			}
+		}
+		return true;
+	});
+
+	if (LoadedPackages.Num() == 0)
+	{
+		return;
+	}
+
+	for (UPackage* Package : LoadedPackages)
+	{
+		// Detach the linker, which keeps the package file open
+		ResetLoaders(Package);
+		ClearStandaloneFlags(Package);
+	}
+
+	TArray<TWeakObjectPtr<UPackage>> WeakPackages(LoadedPackages);
+	LoadedPackages.Reset();
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	int32 NumReferencedPackages = 0;
+	for (const TWeakObjectPtr<UPackage>& WeakPackage : WeakPackages)
+	{
+		if (UPackage* Package = WeakPackage.Get())
+		{
+			// Something outside of the mod still references the package. Moving it aside lets the new version load under its name
+			const FName TrashName = MakeUniqueObjectName(nullptr, UPackage::StaticClass(), *FString::Printf(TEXT("/Temp/ModReload/%s"), *Package->GetName().Replace(TEXT("/"), TEXT("_"))));
+			Package->Rename(*TrashName.ToString(), nullptr, REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional | REN_ForceNoResetLoaders);
+			++NumReferencedPackages;
+		}
+	}
+
+	if (NumReferencedPackages > 0)
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("%d of %d package(s) of mod %s were still referenced and keep their old version"),
+			NumReferencedPackages, WeakPackages.Num(), *Record.Info.Name);
+	}
+}
+
+void FModManager::ClearStandaloneFlags(UPackage* Package)
+{
+	TArray<UObject*> Objects;
+	GetObjectsWithOuter(Package, Objects, true);
+	for (UObject* Object : Objects)
+	{
+		Object->ClearFlags(RF_Standalone);
+	}
+	Package->ClearFlags(RF_Standalone);
+}
+
+void FModManager::UnmountMod(FModRecord& Record)
+{
+	check(IsInGameThread());
+
+	// A loading thread that is mounting the mod on demand has to finish first, or its paks would be mounted after this
+	TSharedFuture<bool> OnDemandMount;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		if (const TSharedFuture<bool>* Mount = OnDemandMounts.Find(Record.Info.Name))
+		{
+			OnDemandMount = *Mount;
+		}
+	}
+
+	if (OnDemandMount.IsValid())
+	{
+		OnDemandMount.Wait();
+	}
+
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		OnDemandMods.Remove(Record.Info.Name);
+
+		bool bRemovedChunks = false;
+		for (FOptionalChunk& Chunk : OptionalChunks)
+		{
+			if (Chunk.ModName == Record.Info.Name)
+			{
+				if (Chunk.bMounted)
+				{
+					PakPlatformFile->Unmount(*Chunk.PakFile);
+				}
+
+				// Indices into the chunks stay valid, an empty chunk never matches a pak again
+				Chunk = FOptionalChunk();
+				bRemovedChunks = true;
+			}
+		}
+
+		if (bRemovedChunks)
+		{
+			for (TMap<FName, int32>::TIterator It = OptionalChunkPackages.CreateIterator(); It; ++It)
+			{
+				if (OptionalChunks[It.Value()].PakFile.IsEmpty())
+				{
+					It.RemoveCurrent();
+				}
+			}
+		}
+	}
+
+	TArray<FString> MountedPaks;
+	PakPlatformFile->GetMountedPakFilenames(MountedPaks);
+
+	for (const FString& PakFile : Record.PakFiles)
+	{
+		if (MountedPaks.Contains(PakFile) && !PakPlatformFile->Unmount(*PakFile))
+		{
+			UE_LOG(LogModSupport, Warning, TEXT("Failed to unmount %s"), *PakFile);
+		}
+	}
+
+	PackageIndex.RemoveMod(Record.Info.Name);
+
+	MergedAssetRegistries.Remove(Record.Info.Name);
+
+	TArray<FCoreRedirect> Redirects;
+	if (ModRedirects.RemoveAndCopyValue(Record.Info.Name, Redirects))
+	{
+		FCoreRedirects::RemoveRedirectList(Redirects, Record.Info.Name);
+	}
+
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		if (OpenShaderLibraries.Remove(Record.Info.Name) > 0)
+		{
+			FShaderCodeLibrary::CloseLibrary(Record.Info.Name);
+		}
+
+		LastUsedTimes.Remove(Record.Info.Name);
+		UnusedMods.Remove(Record.Info.Name);
+	}
+
+	CachedMemoryUsage.Remove(Record.Info.Name);
+
+	if (!Record.Info.VirtualMountPoint.IsEmpty() && FPackageName::MountPointExists(Record.Info.VirtualMountPoint))
+	{
+		FPackageName::UnRegisterMountPoint(Record.Info.VirtualMountPoint, Record.Info.ContentDir);
+	}
+
+	Record.State = EModState::Discovered;
+}
+
+const FModRecord* FModManager::FindMod(const FString& Name) const
+{
+	return Mods.Find(Name);
+}
+
+void FModManager::GetMods(TArray<FModInfo>& OutMods) const
+{
+	OutMods.Reset(Mods.Num());
+
+	for (const TPair<FString, FModRecord>& Pair : Mods)
+	{
+		OutMods.Add(Pair.Value.Info);
+	}
+}
+
+void FModManager::GetLoadedModPackages(TMap<FString, TArray<UPackage*>>& OutPackages) const
+{
+	check(IsInGameThread());
+
+	FString Root;
+	for (TObjectIterator<UPackage> It; It; ++It)
+	{
+		if (GetMountPointRoot(It->GetName(), Root))
+		{
+			const FModRecord* Record = Mods.Find(Root);
+			if (Record != nullptr && Record->State == EModState::Mounted)
+			{
+				OutPackages.FindOrAdd(Root).Add(*It);
+			}
+		}
+	}
+}
+
+void FModManager::GetMemoryUsage(TArray<FModMemoryUsage>& OutUsage) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_MeasureMemory);
+
+	OutUsage.Reset();
+
+	TMap<FString, TArray<UPackage*>> ModPackages;
+	GetLoadedModPackages(ModPackages);
+
+	TMap<FString, double> UsedTimes;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+		UsedTimes = LastUsedTimes;
+	}
+
+	for (const TPair<FString, FModRecord>& Pair : Mods)
+	{
+		if (Pair.Value.State != EModState::Mounted)
+		{
+			continue;
+		}
+
+		FModMemoryUsage& Usage = OutUsage.AddDefaulted_GetRef();
+		Usage.ModName = Pair.Key;
+		Usage.LastUsedTime = UsedTimes.FindRef(Pair.Key);
+
+		const TArray<UPackage*>* Packages = ModPackages.Find(Pair.Key);
+		if (Packages == nullptr)
+		{
+			continue;
+		}
+
+		Usage.NumPackages = Packages->Num();
+
+		TArray<UObject*> Objects;
+		for (UPackage* Package : *Packages)
+		{
+			Objects.Reset();
+			GetObjectsWithOuter(Package, Objects, true);
+			Objects.Add(Package);
+
+			for (UObject* Object : Objects)
+			{
+				// The shallow size of the object is cheap to get, unlike serializing it with FArchiveCountMem
+				Usage.ObjectBytes += Object->GetClass()->GetStructureSize();
+				Usage.ResourceBytes += Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+
+			Usage.NumObjects += Objects.Num();
+		}
+	}
+}
+
+void FModManager::LogMemoryUsage() const
+{
+	TArray<FModMemoryUsage> Usage;
+	GetMemoryUsage(Usage);
+
+	Usage.Sort([](const FModMemoryUsage& A, const FModMemoryUsage& B)
+	{
+		return A.GetTotalBytes() > B.GetTotalBytes();
+	});
+
+	const double Now = FPlatformTime::Seconds();
+
+	int64 TotalBytes = 0;
+	for (const FModMemoryUsage& ModUsage : Usage)
+	{
+		UE_LOG(LogModSupport, Display, TEXT("%s: %.2f MB (%.2f MB objects, %.2f MB resources) in %d package(s) and %d object(s), last used %.0f s ago"),
+			*ModUsage.ModName, ModUsage.GetTotalBytes() / 1024.0 / 1024.0, ModUsage.ObjectBytes / 1024.0 / 1024.0, ModUsage.ResourceBytes / 1024.0 / 1024.0,
+			ModUsage.NumPackages, ModUsage.NumObjects, ModUsage.LastUsedTime > 0.0 ? Now - ModUsage.LastUsedTime : 0.0);
+
+		TotalBytes += ModUsage.GetTotalBytes();
+	}
+
+	UE_LOG(LogModSupport, Display, TEXT("%d mounted mod(s) hold %.2f MB"), Usage.Num(), TotalBytes / 1024.0 / 1024.0);
+}
+
+int32 FModManager::EnforceMemoryBudget()
+{
+	check(IsInGameThread());
+
+	// The mods being loaded are in use, and releasing the others is left for the next check
+	if (IsAsyncLoading())
+	{
+		return 0;
+	}
+
+	const UModSupportSettings* Settings = GetDefault<UModSupportSettings>();
+	const int64 BudgetBytes = int64(Settings->MemoryBudgetMB) * 1024 * 1024;
+
+	// Walking every loaded package is only done again after loads or collections, not on every check
+	UpdateMemoryUsage();
+
+	TArray<FModMemoryUsage> Usage;
+	CachedMemoryUsage.GenerateValueArray(Usage);
+
+	TSet<FString> ReleasableMods;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		for (FModMemoryUsage& ModUsage : Usage)
+		{
+			ModUsage.LastUsedTime = LastUsedTimes.FindRef(ModUsage.ModName);
+		}
+		ReleasableMods = UnusedMods;
+	}
+
+	int64 TotalBytes = 0;
+	for (const FModMemoryUsage& ModUsage : Usage)
+	{
+		TotalBytes += ModUsage.GetTotalBytes();
+	}
+
+	if (TotalBytes <= BudgetBytes)
+	{
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Content of a mod the game didn't mark unused may be in use however long ago it was loaded. Least recently used first
+	Usage.RemoveAll([Now, Settings, &ReleasableMods](const FModMemoryUsage& ModUsage)
+	{
+		return ModUsage.NumPackages == 0 || !ReleasableMods.Contains(ModUsage.ModName) || Now - ModUsage.LastUsedTime < Settings->ModInactiveSeconds;
+	});
+	Usage.Sort([](const FModMemoryUsage& A, const FModMemoryUsage& B)
+	{
+		return A.LastUsedTime < B.LastUsedTime;
+	});
+
+	// The packages are only looked up once there is something to release
+	TMap<FString, TArray<UPackage*>> ModPackages;
+	if (Usage.Num() > 0)
+	{
+		GetLoadedModPackages(ModPackages);
+	}
+
+	TArray<FString> ReleasedMods;
+	int64 ReleasedBytes = 0;
+	for (const FModMemoryUsage& ModUsage : Usage)
+	{
+		if (TotalBytes - ReleasedBytes <= BudgetBytes)
+		{
+			break;
+		}
+
+		for (UPackage* Package : ModPackages.FindRef(ModUsage.ModName))
+		{
+			// The linker stays attached, as objects of the package that are still referenced may load more of it
+			ClearStandaloneFlags(Package);
+		}
+
+		ReleasedMods.Add(ModUsage.ModName);
+		ReleasedBytes += ModUsage.GetTotalBytes();
+	}
+
+	if (ReleasedMods.Num() == 0)
+	{
+		UE_LOG(LogModSupport, Verbose, TEXT("Mods hold %.2f MB, over the budget of %d MB, but no mod holding memory was marked unused and is inactive"),
+			TotalBytes / 1024.0 / 1024.0, Settings->MemoryBudgetMB);
+		return 0;
+	}
+
+	{
+		// Whatever is still referenced survives the collection, and the mod isn't picked again until it was inactive for a while
+		FScopeLock Lock(&OnDemandCritical);
+		for (const FString& ModName : ReleasedMods)
+		{
+			LastUsedTimes.Add(ModName, Now);
+		}
+	}
+
+	// Only the objects of the released mods lost the flags that kept them alive, so one collection releases them all
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	UE_LOG(LogModSupport, Log, TEXT("Mods held %.2f MB, over the budget of %d MB. Released up to %.2f MB of inactive mods: %s"),
+		TotalBytes / 1024.0 / 1024.0, Settings->MemoryBudgetMB, ReleasedBytes / 1024.0 / 1024.0, *FString::Join(ReleasedMods, TEXT(", ")));
+
+	return ReleasedMods.Num();
+}
+
+void FModManager::MarkModUnused(const FString& Name)
+{
+	check(IsInGameThread());
+
+	const FModRecord* Record = Mods.Find(Name);
+	if (Record == nullptr || Record->State != EModState::Mounted)
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Cannot mark mod %s unused, it isn't mounted"), *Name);
+		return;
+	}
+
+	FScopeLock Lock(&OnDemandCritical);
+	UnusedMods.Add(Name);
+}
+
+void FModManager::UpdateMemoryUsage()
+{
+	check(IsInGameThread());
+
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		if (!bMemoryUsageDirty)
+		{
+			return;
+		}
+		bMemoryUsageDirty = false;
+	}
+
+	TArray<FModMemoryUsage> Usage;
+	GetMemoryUsage(Usage);
+
+	CachedMemoryUsage.Reset();
+	for (FModMemoryUsage& ModUsage : Usage)
+	{
+		CachedMemoryUsage.Add(ModUsage.ModName, MoveTemp(ModUsage));
+	}
+}
+
+bool FModManager::HandleMemoryBudgetTick(float DeltaTime)
+{
+	// Mods that are still mounting aren't measured until they completed
+	if (!IsMounting())
+	{
+		EnforceMemoryBudget();
+	}
+
+	return true;
+}
+
+FPakPlatformFile* FModManager::GetPakPlatformFile()
+{
+	FPakPlatformFile* PakPlatformFile = static_cast<FPakPlatformFile*>(FPlatformFileManager::Get().FindPlatformFile(FPakPlatformFile::GetTypeName()));
+
+	if (PakPlatformFile == nullptr)
+	{
+		IPlatformFile& LowerLevel = FPlatformFileManager::Get().GetPlatformFile();
+
+		PakPlatformFile = new FPakPlatformFile();
+		if (!PakPlatformFile->Initialize(&LowerLevel, TEXT("")))
+		{
+			delete PakPlatformFile;
+			return nullptr;
+		}
+
+		PakPlatformFile->InitializeNewAsyncIO();
+		FPlatformFileManager::Get().SetPlatformFile(*PakPlatformFile);
+	}
+
+	return PakPlatformFile;
+}
+
+void FModManager::ReadPackageFilenames(const TArray<FString>& PakFiles, TArray<FName>& OutFilenames)
+{
+	if (!GetDefault<UModSupportSettings>()->bDetectPackageConflicts)
+	{
+		return;
+	}
+
+	for (const FString& PakFile : PakFiles)
+	{
+		FModPackageIndex::ReadPakPackageFilenames(PakFile, OutFilenames);
+	}
+}
+
+void FModManager::IndexPackages(const FString& Name, TArray<FName> Filenames)
+{
+	check(IsInGameThread());
+
+	if (Filenames.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 NumConflicts = PackageIndex.AddMod(Name, GetDefault<UModSupportSettings>()->PakReadOrder, MoveTemp(Filenames));
+	if (NumConflicts > 0)
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Mod %s ships %d package file(s) that other mods ship as well, see ModSupport.ListConflicts"), *Name, NumConflicts);
+	}
+}
+
+void FModManager::LogPackageConflicts() const
+{
+	TArray<FModPackageConflict> Conflicts;
+	PackageIndex.GetConflicts(Conflicts);
+
+	for (const FModPackageConflict& Conflict : Conflicts)
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("%s is shipped by several mods, %s overrides %s"),
+			*Conflict.Filename.ToString(), *Conflict.Winner, *FString::Join(Conflict.Overridden, TEXT(", ")));
+	}
+
+	UE_LOG(LogModSupport, Log, TEXT("%d package file(s) are shipped by more than one mod"), Conflicts.Num());
+}
+
+TSharedFuture<bool> FModManager::StartPakVerification(const FString& Name, const TArray<FString>& PakFiles, FModLoadTimings& Timings)
+{
+	if (PakFiles.Num() == 0)
+	{
+		return TSharedFuture<bool>();
+	}
+
+	const bool bVerifyPaks = GetDefault<UModSupportSettings>()->bVerifyPaks;
+	const FString PakDir = FPaths::GetPath(PakFiles[0]);
+
+	// The destructor waits for all verifications, so they can safely record into the timings
+	FModLoadTimings* TimingsForTask = &Timings;
+
+	// Applying a delta reads and rewrites the whole pak, so it runs here rather than on discovery, and the paks are
+	// verified once they were updated
+	return Async(EAsyncExecution::ThreadPool, [Name, PakFiles, PakDir, bVerifyPaks, TimingsForTask]()
+	{
+		ApplyPakDeltas(Name, PakDir);
+		return !bVerifyPaks || VerifyPaks(Name, PakFiles, *TimingsForTask);
+	}).Share();
+}
+
+bool FModManager::VerifyPaks(const FString& ModName, const TArray<FString>& PakFiles, FModLoadTimings& Timings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_VerifyPaks);
+	FModLoadPhaseScope PhaseScope(Timings, ModName, EModLoadPhase::Verify);
+
+	if (PakFiles.Num() == 0)
+	{
+		return true;
+	}
+
+	FModPakManifest PakManifest;
+	if (!PakManifest.Load(FPaths::GetPath(PakFiles[0]) / FModPakManifest::GetFilename()))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Mod %s has no pak manifest and cannot be verified"), *ModName);
+		return false;
+	}
+
+	FString Error;
+	if (!PakManifest.Verify(PakFiles, Error))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Mod %s failed pak verification: %s"), *ModName, *Error);
+		return false;
+	}
+
+	return true;
+}
+
+bool FModManager::MountPaks(FPakPlatformFile* PakPlatformFile, const FString& ModName, const TArray<FString>& PakFiles, int32 PakReadOrder, FModLoadTimings& Timings)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_MountPaks);
+	FModLoadPhaseScope PhaseScope(Timings, ModName, EModLoadPhase::Mount);
+
+	for (const FString& PakFile : PakFiles)
+	{
+		if (!PakPlatformFile->Mount(*PakFile, PakReadOrder))
+		{
+			UE_LOG(LogModSupport, Error, TEXT("Failed to mount %s"), *PakFile);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FModManager::HandleModMounted(const FString& Name, bool bSuccess)
+{
+	check(IsInGameThread());
+
+	CompleteMount(Name, bSuccess);
+
+	check(PendingMounts > 0 && CurrentWaveMounts > 0);
+	--PendingMounts;
+
+	if (--CurrentWaveMounts == 0)
+	{
+		if (PendingWaves.Num() > 0)
+		{
+			StartNextWave();
+		}
+		else
+		{
+			check(PendingMounts == 0);
+			PendingTasks.Empty();
+
+			if (PackageIndex.GetNumConflicts() > 0)
+			{
+				LogPackageConflicts();
+			}
+
+			AllModsMountedEvent.Broadcast();
+		}
+	}
+}
+
+void FModManager::CompleteMount(const FString& Name, bool bSuccess)
+{
+	check(IsInGameThread());
+
+	FModRecord& Record = Mods.FindChecked(Name);
+
+	if (bSuccess)
+	{
+		RegisterMountPoint(Record);
+	}
+
+	if (bSuccess && LoadOrderRecorder.IsValid())
+	{
+		LoadOrderRecorder->AddMod(Name);
+	}
+
+	if (bSuccess)
+	{
+		FScopeLock Lock(&OnDemandCritical);
+		OpenShaderLibrary_Locked(Name, Record.Info.ContentDir);
+
+		// A mod that was just mounted is about to be used, and holds no memory until its first package is loaded
+		if (MemoryBudgetTickHandle.IsValid())
+		{
+			LastUsedTimes.Add(Name, FPlatformTime::Seconds());
+
+			FModMemoryUsage& Usage = CachedMemoryUsage.Add(Name);
+			Usage.ModName = Name;
+		}
+	}
+
+	Record.State = bSuccess ? EModState::Mounted : EModState::Failed;
+
+	UE_LOG(LogModSupport, Log, TEXT("%s mod %s"), bSuccess ? TEXT("Mounted") : TEXT("Failed to mount"), *Name);
+
+	ModMountedEvent.Broadcast(Record.Info, bSuccess);
+}
+
+void FModManager::RegisterMountPoint(FModRecord& Record)
+{
+	// The package name mount points are not guarded, loading threads only ever read them
+	check(IsInGameThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_RegisterMountPoint);
+	FModLoadPhaseScope PhaseScope(LoadTimings, Record.Info.Name, EModLoadPhase::RegisterAssets);
+
+	Record.Info.ContentDir = Record.BaseDir / TEXT("Content/");
+	Record.Info.VirtualMountPoint = FString::Printf(TEXT("/%s/"), *Record.Info.Name);
+
+	// Merged before the mount point exists, so the asset registry knows the content of the mod as soon as it is mounted
+	MergeAssetRegistry(Record);
+
+	// Redirected before the mount point exists, so no package of the mod is loaded without them
+	AddSharedContentRedirects(Record);
+
+	if (!FPackageName::MountPointExists(Record.Info.VirtualMountPoint))
+	{
+		FPackageName::RegisterMountPoint(Record.Info.VirtualMountPoint, Record.Info.ContentDir);
+	}
+}
+
+void FModManager::AddSharedContentRedirects(const FModRecord& Record)
+{
+	check(IsInGameThread());
+
+	if (ModRedirects.Contains(Record.Info.Name))
+	{
+		return;
+	}
+
+	const FString Filename = Record.BaseDir / TEXT("Content") / TEXT("Paks") / FPlatformProperties::PlatformName() / FModSharedContentMap::GetFilename();
+
+	FModSharedContentMap SharedContentMap;
+	if (!IFileManager::Get().FileExists(*Filename) || !SharedContentMap.Load(Filename))
+	{
+		return;
+	}
+
+	TArray<FCoreRedirect>& Redirects = ModRedirects.Add(Record.Info.Name);
+	Redirects.Reserve(SharedContentMap.Redirects.Num());
+	for (const TPair<FString, FString>& Pair : SharedContentMap.Redirects)
+	{
+		Redirects.Emplace(ECoreRedirectFlags::Type_Package, Pair.Key, Pair.Value);
+	}
+
+	FCoreRedirects::AddRedirectList(Redirects, Record.Info.Name);
+
+	UE_LOG(LogModSupport, Log, TEXT("Redirecting %d package(s) of mod %s to the mods it requires"), Redirects.Num(), *Record.Info.Name);
+}
+
+void FModManager::MergeAssetRegistry(const FModRecord& Record)
+{
+	check(IsInGameThread());
+
+	if (!GetDefault<UModSupportSettings>()->bMergeAssetRegistry || MergedAssetRegistries.Contains(Record.Info.Name))
+	{
+		return;
+	}
+
+	// The registry ships next to the paks rather than in them, so mods registered for on-demand mounting are found by asset queries too
+	const FString Filename = Record.BaseDir / TEXT("Content") / TEXT("Paks") / FPlatformProperties::PlatformName() / GetAssetRegistryFilename();
+
+	TArray<uint8> Bytes;
+	if (!IFileManager::Get().FileExists(*Filename) || !FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return;
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	FAssetRegistrySerializationOptions Options;
+	AssetRegistry.InitializeSerializationOptions(Options);
+
+	FMemoryReader Reader(Bytes);
+	FAssetRegistryState State;
+	if (!State.Serialize(Reader, Options) || Reader.IsError())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to read the asset registry of mod %s, its content has to be scanned to be found by asset queries"), *Record.Info.Name);
+		return;
+	}
+
+	AssetRegistry.AppendState(State);
+	MergedAssetRegistries.Add(Record.Info.Name);
+
+	UE_LOG(LogModSupport, Verbose, TEXT("Merged %d asset(s) of mod %s into the asset registry"), State.GetNumAssets(), *Record.Info.Name);
+}
+
+void FModManager::OpenShaderLibrary_Locked(const FString& Name, const FString& ContentDir)
+{
+	if (OpenShaderLibraries.Contains(Name))
+	{
+		return;
+	}
+
+	// The packager cooks every mod with a shared shader library named after the mod, staged into its content directory
+	TArray<FString> LibraryFiles;
+	IFileManager::Get().FindFiles(LibraryFiles, *(ContentDir / FString::Printf(TEXT("ShaderArchive-%s-*.ushaderbytecode"), *Name)), true, false);
+	if (LibraryFiles.Num() == 0)
+	{
+		return;
+	}
+
+	if (FShaderCodeLibrary::OpenLibrary(Name, ContentDir))
+	{
+		OpenShaderLibraries.Add(Name);
+		UE_LOG(LogModSupport, Log, TEXT("Opened the shader library of mod %s"), *Name);
+	}
+	else
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to open the shader library of mod %s, its materials compile their shaders on first use"), *Name);
+	}
+}
+
+void FModManager::RegisterModsOnDemand(const TArray<TArray<FString>>& Waves)
+{
+	TArray<FString> MountedPaks;
+	PakPlatformFile->GetMountedPakFilenames(MountedPaks);
+
+	const int32 PakReadOrder = GetDefault<UModSupportSettings>()->PakReadOrder;
+
+	int32 NumRegistered = 0;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		for (const TArray<FString>& Wave : Waves)
+		{
+			for (const FString& Name : Wave)
+			{
+				FModRecord& Record = Mods.FindChecked(Name);
+				RegisterMountPoint(Record);
+				Record.State = EModState::Registered;
+
+				if (LoadOrderRecorder.IsValid())
+				{
+					LoadOrderRecorder->AddMod(Name);
+				}
+
+				// The mount point of a mod is always /<Name>/, so its root doubles as the mod name
+				FOnDemandMod& OnDemandMod = OnDemandMods.Add(Name);
+				OnDemandMod.Name = Name;
+				OnDemandMod.PluginsRequire = Record.Info.PluginsRequire;
+				OnDemandMod.ContentDir = Record.Info.ContentDir;
+				OnDemandMod.PakReadOrder = PakReadOrder;
+				OnDemandMod.PakFiles = Record.PakFiles.FilterByPredicate([&MountedPaks](const FString& PakFile)
+				{
+					return !MountedPaks.Contains(PakFile);
+				});
+
+				RegisterOptionalChunks_Locked(Record, MountedPaks, PakReadOrder);
+
+				++NumRegistered;
+			}
+		}
+	}
+
+	BindPackageLoadDelegates();
+
+	UE_LOG(LogModSupport, Log, TEXT("Registered %d mod(s) for on-demand mounting"), NumRegistered);
+
+	AllModsMountedEvent.Broadcast();
+}
+
+bool FModManager::GetMountPointRoot(const FString& PackageName, FString& OutRoot)
+{
+	if (PackageName.Len() < 2 || PackageName[0] != TEXT('/'))
+	{
+		return false;
+	}
+
+	const int32 RootEnd = PackageName.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, 1);
+	if (RootEnd == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutRoot = PackageName.Mid(1, RootEnd - 1);
+	return true;
+}
+
+void FModManager::HandlePackageLoad(const FString& PackageName)
+{
+	FString Root;
+	if (!GetMountPointRoot(PackageName, Root))
+	{
+		return;
+	}
+
+	TArray<FOnDemandMod> ModsToMount;
+	TSharedFuture<bool> OnDemandMount;
+	{
+		FScopeLock Lock(&OnDemandCritical);
+
+		if (OnDemandMods.Num() > 0 || OnDemandMounts.Num() > 0)
+		{
+			OnDemandMount = ClaimOnDemandMod_Locked(Root, ModsToMount);
+		}
+
+		if (MemoryBudgetTickHandle.IsValid())
+		{
+			LastUsedTimes.Add(Root, FPlatformTime::Seconds());
+			UnusedMods.Remove(Root);
+			bMemoryUsageDirty = true;
+		}
+
+		if (!OnDemandMount.IsValid() && OptionalChunkPackages.Num() > 0)
+		{
+			MountOptionalChunk_Locked(PackageName);
+		}
+	}
+
+	if (!OnDemandMount.IsValid())
+	{
+		return;
+	}
+
+	// Verifying the paks can take a while, so it is waited for without the lock and only holds up loads of the same mods
+	for (const FOnDemandMod& Mod : ModsToMount)
+	{
+		MountOnDemand(Mod);
+	}
+
+	OnDemandMount.Wait();
+
+	// The optional chunks of a mod are only registered for its packages once the mod itself mounted
+	FScopeLock Lock(&OnDemandCritical);
+
+	if (OptionalChunkPackages.Num() > 0)
+	{
+		MountOptionalChunk_Locked(PackageName);
+	}
+}
+
+TSharedFuture<bool> FModManager::ClaimOnDemandMod_Locked(const FString& Root, TArray<FOnDemandMod>& OutModsToMount)
+{
+	if (const TSharedFuture<bool>* Mount = OnDemandMounts.Find(Root))
+	{
+		// Mounting on another thread, or taken by this one already as the dependency of another mod
+		return *Mount;
+	}
+
+	FOnDemandMod Mod;
+	if (!OnDemandMods.RemoveAndCopyValue(Root, Mod))
+	{
+		// Not a registered mod, or one that was mounted already
+		return TSharedFuture<bool>();
+	}
+
+	Mod.MountPromise = MakeShared<TPromise<bool>>();
+	TSharedFuture<bool> Mount = Mod.MountPromise->GetFuture().Share();
+	OnDemandMounts.Add(Mod.Name, Mount);
+
+	for (const FString& Dependency : Mod.PluginsRequire)
+	{
+		TSharedFuture<bool> DependencyMount = ClaimOnDemandMod_Locked(Dependency, OutModsToMount);
+		if (DependencyMount.IsValid())
+		{
+			Mod.DependencyMounts.Add(MoveTemp(DependencyMount));
+		}
+	}
+
+	// Every mod taken here is verified in parallel while the ones before it mount
+	Mod.PakVerification = StartPakVerification(Mod.Name, Mod.PakFiles, LoadTimings);
+
+	OutModsToMount.Add(MoveTemp(Mod));
+	return Mount;
+}
+
+void FModManager::MountOnDemand(const FOnDemandMod& Mod)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_MountOnDemand);
+	FModLoadPhaseScope PhaseScope(LoadTimings, Mod.Name, EModLoadPhase::FirstPackageLoad);
+
+	// Dependencies taken by this thread mounted right before, the others are mounted by the thread that took them
+	bool bSuccess = true;
+	for (const TSharedFuture<bool>& DependencyMount : Mod.DependencyMounts)
+	{
+		bSuccess &= DependencyMount.Get();
+	}
+
+	bSuccess = bSuccess && (!Mod.PakVerification.IsValid() || Mod.PakVerification.Get());
+
+	// The package is loaded right after this returns, so the paks are mounted on the loading thread
+	bSuccess = bSuccess && MountPaks(PakPlatformFile, Mod.Name, Mod.PakFiles, Mod.PakReadOrder, LoadTimings);
+
+	TArray<FName> PackageFilenames;
+	if (bSuccess)
+	{
+		ReadPackageFilenames(Mod.PakFiles, PackageFilenames);
+	}
+
+	TWeakPtr<FModManager> WeakThis = AsShared();
+	const FString Name = Mod.Name;
+
+	AsyncTask(ENamedThreads::GameThread, [WeakThis, Name, bSuccess, PackageFilenames = MoveTemp(PackageFilenames)]() mutable
+	{
+		if (TSharedPtr<FModManager> This = WeakThis.Pin())
+		{
+			This->IndexPackages(Name, MoveTemp(PackageFilenames));
+			This->CompleteMount(Name, bSuccess);
+		}
+	});
+
+	FScopeLock Lock(&OnDemandCritical);
+
+	// Materials of the package look up their shaders while they are serialized, so the library can't wait for the game thread
+	if (bSuccess)
+	{
+		OpenShaderLibrary_Locked(Mod.Name, Mod.ContentDir);
+	}
+
+	OnDemandMounts.Remove(Mod.Name);
+	Mod.MountPromise->SetValue(bSuccess);
+}
+
+void FModManager::BindPackageLoadDelegates()
+{
+	if (!SyncLoadPackageHandle.IsValid())
+	{
+		SyncLoadPackageHandle = FCoreDelegates::OnSyncLoadPackage.AddRaw(this, &FModManager::HandlePackageLoad);
+		AsyncLoadPackageHandle = FCoreDelegates::OnAsyncLoadPackage.AddRaw(this, &FModManager::HandlePackageLoad);
+	}
+}
+
+void FModManager::RegisterOptionalChunks_Locked(const FModRecord& Record, const TArray<FString>& MountedPaks, int32 PakReadOrder)
+{
+	for (const FModChunk& Chunk : Record.OptionalChunks)
+	{
+		const bool bAlreadyRegistered = OptionalChunks.ContainsByPredicate([&Chunk](const FOptionalChunk& OptionalChunk)
+		{
+			return OptionalChunk.PakFile == Chunk.PakFile;
+		});
+
+		if (bAlreadyRegistered || MountedPaks.Contains(Chunk.PakFile))
+		{
+			continue;
+		}
+
+		const int32 ChunkIndex = OptionalChunks.Num();
+
+		FOptionalChunk& OptionalChunk = OptionalChunks.AddDefaulted_GetRef();
+		OptionalChunk.ModName = Record.Info.Name;
+		OptionalChunk.PakFile = Chunk.PakFile;
+		OptionalChunk.PakReadOrder = PakReadOrder;
+		OptionalChunk.bVerify = GetDefault<UModSupportSettings>()->bVerifyPaks;
+
+		for (const FString& PackageName : Chunk.Packages)
+		{
+			OptionalChunkPackages.Add(FName(*PackageName), ChunkIndex);
+		}
+	}
+}
+
+void FModManager::MountOptionalChunk_Locked(const FString& PackageName)
+{
+	// Looking up without adding keeps the names of unrelated loads out of the name table
+	const FName LongPackageName(*FPackageName::ObjectPathToPackageName(PackageName), FNAME_Find);
+	if (LongPackageName.IsNone())
+	{
+		return;
+	}
+
+	const int32* ChunkIndex = OptionalChunkPackages.Find(LongPackageName);
+	if (ChunkIndex == nullptr || OptionalChunks[*ChunkIndex].bMounted)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ModSupport_MountChunk);
+
+	// The chunk is clustered by hard references, so the package loaded right after this finds all of its imports mounted
+	FOptionalChunk& Chunk = OptionalChunks[*ChunkIndex];
+	Chunk.bMounted = true;
+
+	// Chunks are only verified once they are needed, like they are only mounted once they are needed
+	if (Chunk.bVerify && !VerifyPaks(Chunk.ModName, { Chunk.PakFile }, LoadTimings))
+	{
+		return;
+	}
+
+	if (MountPaks(PakPlatformFile, Chunk.ModName, { Chunk.PakFile }, Chunk.PakReadOrder, LoadTimings))
+	{
+		UE_LOG(LogModSupport, Log, TEXT("Mounted optional chunk %s of mod %s"), *FPaths::GetCleanFilename(Chunk.PakFile), *Chunk.ModName);
+
+		TArray<FName> PackageFilenames;
+		ReadPackageFilenames({ Chunk.PakFile }, PackageFilenames);
+
+		if (PackageFilenames.Num() > 0)
+		{
+			TWeakPtr<FModManager> WeakThis = AsShared();
+			const FString ModName = Chunk.ModName;
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, ModName, PackageFilenames = MoveTemp(PackageFilenames)]() mutable
+			{
+				if (TSharedPtr<FModManager> This = WeakThis.Pin())
+				{
+					This->IndexPackages(ModName, MoveTemp(PackageFilenames));
+				}
+			});
+		}
+	}
+}
@@ -0,0 +1,139 @@
+#include "ModManifestCache.h"
+
+#include "ModSupportLog.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ModManifestCache
+{
+	static const uint32 Magic = 0x4D4F444D; // 'MODM'
+
+	/** Bump whenever the layout of the cache, of FModInfo or of FModPakDirInfo changes */
+	static const int32 Version = 2;
+}
+
+FModManifestCache::FModManifestCache()
+	: bDirty(false)
+{
+}
+
+bool FModManifestCache::Load(const FString& Filename)
+{
+	Entries.Reset();
+	PakDirEntries.Reset();
+	bDirty = false;
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic << Version;
+
+	if (Magic != ModManifestCache::Magic || Version != ModManifestCache::Version)
+	{
+		UE_LOG(LogModSupport, Log, TEXT("Ignoring outdated mod manifest cache %s"), *Filename);
+		return false;
+	}
+
+	Reader << Entries << PakDirEntries;
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Mod manifest cache %s is corrupt, all descriptors will be parsed"), *Filename);
+		Entries.Reset();
+		PakDirEntries.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FModManifestCache::Save(const FString& Filename) const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = ModManifestCache::Magic;
+	int32 Version = ModManifestCache::Version;
+	Writer << Magic << Version;
+	Writer << const_cast<TMap<FString, FEntry>&>(Entries);
+	Writer << const_cast<TMap<FString, FPakDirEntry>&>(PakDirEntries);
+
+	if (!FFileHelper::SaveArrayToFile(Data, *Filename))
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to save mod manifest cache %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+const FModInfo* FModManifestCache::Find(const FString& DescriptorFilename, int64 Size, const FDateTime& Timestamp) const
+{
+	const FEntry* Entry = Entries.Find(DescriptorFilename);
+	if (Entry != nullptr && Entry->Size == Size && Entry->Timestamp == Timestamp)
+	{
+		return &Entry->Info;
+	}
+
+	return nullptr;
+}
+
+void FModManifestCache::Add(const FString& DescriptorFilename, int64 Size, const FDateTime& Timestamp, const FModInfo& Info)
+{
+	FEntry& Entry = Entries.FindOrAdd(DescriptorFilename);
+	Entry.Size = Size;
+	Entry.Timestamp = Timestamp;
+	Entry.Info = Info;
+
+	bDirty = true;
+}
+
+const FModPakDirInfo* FModManifestCache::FindPakDirInfo(const FString& DescriptorFilename, const FDateTime& PakManifestTimestamp, const FDateTime& ChunkMapTimestamp) const
+{
+	const FPakDirEntry* Entry = PakDirEntries.Find(DescriptorFilename);
+	if (Entry != nullptr && Entry->PakManifestTimestamp == PakManifestTimestamp && Entry->ChunkMapTimestamp == ChunkMapTimestamp)
+	{
+		return &Entry->Info;
+	}
+
+	return nullptr;
+}
+
+void FModManifestCache::AddPakDirInfo(const FString& DescriptorFilename, const FDateTime& PakManifestTimestamp, const FDateTime& ChunkMapTimestamp, const FModPakDirInfo& Info)
+{
+	FPakDirEntry& Entry = PakDirEntries.FindOrAdd(DescriptorFilename);
+	Entry.PakManifestTimestamp = PakManifestTimestamp;
+	Entry.ChunkMapTimestamp = ChunkMapTimestamp;
+	Entry.Info = Info;
+
+	bDirty = true;
+}
+
+void FModManifestCache::RemoveAllExcept(const TSet<FString>& DescriptorFilenames)
+{
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (!DescriptorFilenames.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+			bDirty = true;
+		}
+	}
+
+	for (auto It = PakDirEntries.CreateIterator(); It; ++It)
+	{
+		if (!DescriptorFilenames.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+			bDirty = true;
+		}
+	}
+}
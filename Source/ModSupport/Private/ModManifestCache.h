@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModChunkMap.h"
+#include "ModInfo.h"
+
+/** What discovery reads from the pak manifest and the chunk map next to the paks of a mod */
+struct FModPakDirInfo
+{
+	/** True if the mod has a pak manifest */
+	bool bHasPakManifest = false;
+
+	/** Clean filenames of the paks of the installed release, as listed by the pak manifest */
+	TArray<FString> ReleasePaks;
+
+	/** Optional chunks of the mod, with pak filenames relative to the pak directory */
+	TArray<FModChunk> Chunks;
+
+	friend FArchive& operator<<(FArchive& Ar, FModPakDirInfo& Info)
+	{
+		return Ar << Info.bHasPakManifest << Info.ReleasePaks << Info.Chunks;
+	}
+};
+
+/**
+ * Binary cache of the FModInfo parsed from every mod descriptor, so unchanged .uplugin files
+ * don't have to be parsed again on the next boot. Entries are keyed by descriptor path and
+ * invalidated by the descriptor's size and modification time. The pak manifest and chunk map
+ * of every mod are cached the same way, invalidated by their modification times.
+ */
+class FModManifestCache
+{
+public:
+
+	FModManifestCache();
+
+	/** Loads the cache with a single read. A missing or outdated cache file leaves the cache empty */
+	bool Load(const FString& Filename);
+
+	/** Writes the cache to disk */
+	bool Save(const FString& Filename) const;
+
+	/** @return The cached info of the descriptor, or nullptr if it is not cached or has changed since */
+	const FModInfo* Find(const FString& DescriptorFilename, int64 Size, const FDateTime& Timestamp) const;
+
+	/** Adds or replaces the cached info of a descriptor */
+	void Add(const FString& DescriptorFilename, int64 Size, const FDateTime& Timestamp, const FModInfo& Info);
+
+	/**
+	 * @param	PakManifestTimestamp	Modification time of the mod's pak manifest, FDateTime::MinValue() if it has none
+	 * @param	ChunkMapTimestamp		Modification time of the mod's chunk map, FDateTime::MinValue() if it has none
+	 * @return	The cached pak directory info of the descriptor's mod, or nullptr if it is not cached or has changed since
+	 */
+	const FModPakDirInfo* FindPakDirInfo(const FString& DescriptorFilename, const FDateTime& PakManifestTimestamp, const FDateTime& ChunkMapTimestamp) const;
+
+	/** Adds or replaces the cached pak directory info of the descriptor's mod */
+	void AddPakDirInfo(const FString& DescriptorFilename, const FDateTime& PakManifestTimestamp, const FDateTime& ChunkMapTimestamp, const FModPakDirInfo& Info);
+
+	/** Drops the entries of every descriptor not in the given set, e.g. of uninstalled mods */
+	void RemoveAllExcept(const TSet<FString>& DescriptorFilenames);
+
+	/** @return True if the cache was modified since it was loaded */
+	bool IsDirty() const { return bDirty; }
+
+private:
+
+	struct FEntry
+	{
+		int64 Size = 0;
+		FDateTime Timestamp;
+		FModInfo Info;
+
+		friend FArchive& operator<<(FArchive& Ar, FEntry& Entry)
+		{
+			return Ar << Entry.Size << Entry.Timestamp << Entry.Info;
+		}
+	};
+
+	TMap<FString, FEntry> Entries;
+
+	struct FPakDirEntry
+	{
+		FDateTime PakManifestTimestamp;
+		FDateTime ChunkMapTimestamp;
+		FModPakDirInfo Info;
+
+		friend FArchive& operator<<(FArchive& Ar, FPakDirEntry& Entry)
+		{
+			return Ar << Entry.PakManifestTimestamp << Entry.ChunkMapTimestamp << Entry.Info;
+		}
+	};
+
+	/** Pak directory info of every mod, by descriptor path */
+	TMap<FString, FPakDirEntry> PakDirEntries;
+
+	bool bDirty;
+};
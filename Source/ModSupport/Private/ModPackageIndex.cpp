@@ -0,0 +1,152 @@
+#include "ModPackageIndex.h"
+
+#include "ModSupportLog.h"
+#include "HAL/PlatformFilemanager.h"
+#include "IPlatformFilePak.h"
+#include "Misc/PackageName.h"
+
+int32 FModPackageIndex::AddMod(const FString& ModName, int32 Priority, TArray<FName> Filenames)
+{
+	int32 ModIndex = INDEX_NONE;
+	if (const int32* ExistingIndex = ModIndices.Find(ModName))
+	{
+		ModIndex = *ExistingIndex;
+	}
+	else
+	{
+		ModIndex = IndexedMods.IndexOfByPredicate([](const FIndexedMod& IndexedMod) { return IndexedMod.Name.IsEmpty(); });
+		if (ModIndex == INDEX_NONE)
+		{
+			ModIndex = IndexedMods.AddDefaulted();
+		}
+
+		FIndexedMod& IndexedMod = IndexedMods[ModIndex];
+		IndexedMod.Name = ModName;
+		IndexedMod.Priority = Priority;
+		IndexedMod.Sequence = NextSequence++;
+
+		ModIndices.Add(ModName, ModIndex);
+	}
+
+	int32 NumConflicts = 0;
+	for (const FName& Filename : Filenames)
+	{
+		TArray<int32, TInlineAllocator<1>>& FileProviders = Providers.FindOrAdd(Filename);
+		FileProviders.AddUnique(ModIndex);
+
+		if (FileProviders.Num() > 1)
+		{
+			ConflictingFiles.Add(Filename);
+			++NumConflicts;
+		}
+	}
+
+	IndexedMods[ModIndex].Filenames.Append(MoveTemp(Filenames));
+	return NumConflicts;
+}
+
+void FModPackageIndex::RemoveMod(const FString& ModName)
+{
+	int32 ModIndex = INDEX_NONE;
+	if (!ModIndices.RemoveAndCopyValue(ModName, ModIndex))
+	{
+		return;
+	}
+
+	FIndexedMod& IndexedMod = IndexedMods[ModIndex];
+
+	for (const FName& Filename : IndexedMod.Filenames)
+	{
+		TArray<int32, TInlineAllocator<1>>* FileProviders = Providers.Find(Filename);
+		if (FileProviders == nullptr)
+		{
+			continue;
+		}
+
+		FileProviders->RemoveSingleSwap(ModIndex);
+
+		if (FileProviders->Num() < 2)
+		{
+			ConflictingFiles.Remove(Filename);
+		}
+		if (FileProviders->Num() == 0)
+		{
+			Providers.Remove(Filename);
+		}
+	}
+
+	IndexedMod = FIndexedMod();
+}
+
+void FModPackageIndex::GetConflicts(TArray<FModPackageConflict>& OutConflicts) const
+{
+	OutConflicts.Reset(ConflictingFiles.Num());
+
+	for (const FName& Filename : ConflictingFiles)
+	{
+		const TArray<int32, TInlineAllocator<1>>& FileProviders = Providers.FindChecked(Filename);
+		const int32 WinnerIndex = FindWinner(FileProviders);
+
+		FModPackageConflict& Conflict = OutConflicts.AddDefaulted_GetRef();
+		Conflict.Filename = Filename;
+		Conflict.Winner = IndexedMods[WinnerIndex].Name;
+
+		for (int32 ModIndex : FileProviders)
+		{
+			if (ModIndex != WinnerIndex)
+			{
+				Conflict.Overridden.Add(IndexedMods[ModIndex].Name);
+			}
+		}
+	}
+
+	OutConflicts.Sort([](const FModPackageConflict& A, const FModPackageConflict& B) { return A.Filename.LexicalLess(B.Filename); });
+}
+
+const FString* FModPackageIndex::FindProvider(FName Filename) const
+{
+	const TArray<int32, TInlineAllocator<1>>* FileProviders = Providers.Find(Filename);
+	return FileProviders != nullptr ? &IndexedMods[FindWinner(*FileProviders)].Name : nullptr;
+}
+
+int32 FModPackageIndex::FindWinner(const TArray<int32, TInlineAllocator<1>>& ModIndices) const
+{
+	int32 WinnerIndex = ModIndices[0];
+	for (int32 ModIndex : ModIndices)
+	{
+		const FIndexedMod& Candidate = IndexedMods[ModIndex];
+		const FIndexedMod& Winner = IndexedMods[WinnerIndex];
+
+		// Like the pak platform file, which searches paks by descending read order and keeps equal orders in mount order
+		if (Candidate.Priority > Winner.Priority || (Candidate.Priority == Winner.Priority && Candidate.Sequence < Winner.Sequence))
+		{
+			WinnerIndex = ModIndex;
+		}
+	}
+	return WinnerIndex;
+}
+
+bool FModPackageIndex::ReadPakPackageFilenames(const FString& PakFile, TArray<FName>& OutFilenames)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	IPlatformFile* LowerLevel = PlatformFile.GetLowerLevel() != nullptr ? PlatformFile.GetLowerLevel() : &PlatformFile;
+
+	// Only the index of the pak is read
+	FPakFile Pak(LowerLevel, *PakFile, false);
+	if (!Pak.IsValid())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to read the index of %s"), *PakFile);
+		return false;
+	}
+
+	for (FPakFile::FFileIterator It(Pak); It; ++It)
+	{
+		const FString& Filename = It.Filename();
+		if (FPackageName::IsPackageFilename(Filename))
+		{
+			OutFilenames.Add(FName(*(Pak.GetMountPoint() / Filename)));
+		}
+	}
+
+	return true;
+}
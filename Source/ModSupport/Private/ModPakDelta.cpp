@@ -0,0 +1,428 @@
+#include "ModPakDelta.h"
+
+#include "ModSupportLog.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "Misc/SecureHash.h"
+
+namespace ModPakDelta
+{
+	static const uint32 Magic = 0x544C444D;
+	static const int32 FormatVersion = 1;
+
+	/** Size of the buffers paks are streamed through, which bounds the memory used by creating and applying a delta */
+	static const int32 BufferSize = 4 * 1024 * 1024;
+
+	enum class EOp : uint8
+	{
+		End,
+		/** Followed by the offset and length of a range of the old pak */
+		Copy,
+		/** Followed by a length and that many bytes */
+		Insert,
+	};
+
+	/** Weak hash of a window that can be moved by a byte in constant time, as used by rsync */
+	struct FRollingHash
+	{
+		uint32 A = 0;
+		uint32 B = 0;
+		uint32 Length = 0;
+
+		void Init(const uint8* Data, int32 InLength)
+		{
+			A = 0;
+			B = 0;
+			Length = InLength;
+
+			for (int32 Index = 0; Index < InLength; ++Index)
+			{
+				A += Data[Index];
+				B += (InLength - Index) * Data[Index];
+			}
+		}
+
+		void Roll(uint8 Out, uint8 In)
+		{
+			A = A - Out + In;
+			B = B - Length * Out + A;
+		}
+
+		uint32 Get() const
+		{
+			return (A & 0xffff) | (B << 16);
+		}
+	};
+
+	/** Writes the operations of a delta, merging copies of adjacent ranges of the old pak */
+	struct FOpWriter
+	{
+		FArchive& Ar;
+		int64 CopyOffset = 0;
+		int64 CopyLength = 0;
+
+		explicit FOpWriter(FArchive& InAr)
+			: Ar(InAr)
+		{
+		}
+
+		void Copy(int64 Offset, int64 Length)
+		{
+			if (CopyLength > 0 && CopyOffset + CopyLength == Offset)
+			{
+				CopyLength += Length;
+				return;
+			}
+
+			FlushCopy();
+			CopyOffset = Offset;
+			CopyLength = Length;
+		}
+
+		void Insert(const uint8* Data, int64 Length)
+		{
+			if (Length == 0)
+			{
+				return;
+			}
+
+			FlushCopy();
+
+			EOp Op = EOp::Insert;
+			Ar << Op;
+			Ar << Length;
+			Ar.Serialize(const_cast<uint8*>(Data), Length);
+		}
+
+		void End()
+		{
+			FlushCopy();
+
+			EOp Op = EOp::End;
+			Ar << Op;
+		}
+
+		void FlushCopy()
+		{
+			if (CopyLength > 0)
+			{
+				EOp Op = EOp::Copy;
+				Ar << Op;
+				Ar << CopyOffset;
+				Ar << CopyLength;
+				CopyLength = 0;
+			}
+		}
+	};
+
+	/** Copies bytes from one archive to another through a buffer, hashing them on the way */
+	static bool CopyBytes(FArchive& From, FArchive& To, int64 Length, TArray<uint8>& Buffer, FSHA1& Hash)
+	{
+		while (Length > 0)
+		{
+			const int32 ChunkSize = (int32)FMath::Min<int64>(Length, Buffer.Num());
+
+			From.Serialize(Buffer.GetData(), ChunkSize);
+			if (From.IsError())
+			{
+				return false;
+			}
+
+			Hash.Update(Buffer.GetData(), ChunkSize);
+			To.Serialize(Buffer.GetData(), ChunkSize);
+			Length -= ChunkSize;
+		}
+
+		return !To.IsError();
+	}
+}
+
+bool FModPakDelta::Create(const FString& OldPakFile, const FString& NewPakFile, const FString& DeltaFile, int32 BlockSize)
+{
+	using namespace ModPakDelta;
+
+	check(BlockSize > 0 && BlockSize <= BufferSize / 2);
+
+	TUniquePtr<FArchive> OldReader(IFileManager::Get().CreateFileReader(*OldPakFile));
+	TUniquePtr<FArchive> NewReader(IFileManager::Get().CreateFileReader(*NewPakFile));
+	if (!OldReader.IsValid() || !NewReader.IsValid())
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to open %s or %s"), *OldPakFile, *NewPakFile);
+		return false;
+	}
+
+	const int64 OldSize = OldReader->TotalSize();
+	const int64 NewSize = NewReader->TotalSize();
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(BufferSize);
+
+	// Index the full blocks of the old pak. The index holds two hashes per block, never the blocks themselves
+	const int32 NumBlocks = (int32)(OldSize / BlockSize);
+
+	TMultiMap<uint32, int32> WeakHashes;
+	TArray<uint64> StrongHashes;
+	StrongHashes.SetNumUninitialized(NumBlocks);
+
+	for (int32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+	{
+		OldReader->Serialize(Buffer.GetData(), BlockSize);
+		if (OldReader->IsError())
+		{
+			UE_LOG(LogModSupport, Error, TEXT("Failed to read %s"), *OldPakFile);
+			return false;
+		}
+
+		FRollingHash WeakHash;
+		WeakHash.Init(Buffer.GetData(), BlockSize);
+
+		WeakHashes.Add(WeakHash.Get(), BlockIndex);
+		StrongHashes[BlockIndex] = CityHash64((const char*)Buffer.GetData(), BlockSize);
+	}
+
+	OldReader.Reset();
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*DeltaFile));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to create %s"), *DeltaFile);
+		return false;
+	}
+
+	// The hash of the new pak is only known at the end, the header is written again once it is
+	uint32 HeaderMagic = Magic;
+	int32 HeaderVersion = FormatVersion;
+	int64 HeaderOldSize = OldSize;
+	int64 HeaderNewSize = NewSize;
+	FSHAHash NewHash;
+
+	*Writer << HeaderMagic << HeaderVersion << HeaderOldSize << HeaderNewSize << NewHash;
+
+	FOpWriter OpWriter(*Writer);
+	FSHA1 NewHasher;
+
+	// The new pak is streamed through the buffer, which holds the bytes from Pos on that were read so far
+	int64 NewRemaining = NewSize;
+	int32 BufferEnd = 0;
+	int32 Pos = 0;
+	int32 LiteralStart = 0;
+
+	FRollingHash WindowHash;
+	bool bWindowHashValid = false;
+
+	for (;;)
+	{
+		if (BufferEnd - Pos < BlockSize && NewRemaining > 0)
+		{
+			// Pending literal bytes are written out, so only the unmatched window has to be kept
+			OpWriter.Insert(Buffer.GetData() + LiteralStart, Pos - LiteralStart);
+
+			FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + Pos, BufferEnd - Pos);
+			BufferEnd -= Pos;
+			Pos = 0;
+			LiteralStart = 0;
+
+			const int32 ReadSize = (int32)FMath::Min<int64>(NewRemaining, BufferSize - BufferEnd);
+			NewReader->Serialize(Buffer.GetData() + BufferEnd, ReadSize);
+			if (NewReader->IsError())
+			{
+				UE_LOG(LogModSupport, Error, TEXT("Failed to read %s"), *NewPakFile);
+				return false;
+			}
+
+			NewHasher.Update(Buffer.GetData() + BufferEnd, ReadSize);
+			BufferEnd += ReadSize;
+			NewRemaining -= ReadSize;
+			bWindowHashValid = false;
+		}
+
+		if (BufferEnd - Pos < BlockSize)
+		{
+			break;
+		}
+
+		if (!bWindowHashValid)
+		{
+			WindowHash.Init(Buffer.GetData() + Pos, BlockSize);
+			bWindowHashValid = true;
+		}
+
+		int32 MatchingBlock = INDEX_NONE;
+
+		TArray<int32, TInlineAllocator<4>> Candidates;
+		WeakHashes.MultiFind(WindowHash.Get(), Candidates);
+		if (Candidates.Num() > 0)
+		{
+			const uint64 StrongHash = CityHash64((const char*)Buffer.GetData() + Pos, BlockSize);
+			for (int32 Candidate : Candidates)
+			{
+				if (StrongHashes[Candidate] == StrongHash)
+				{
+					MatchingBlock = Candidate;
+					break;
+				}
+			}
+		}
+
+		if (MatchingBlock != INDEX_NONE)
+		{
+			OpWriter.Insert(Buffer.GetData() + LiteralStart, Pos - LiteralStart);
+			OpWriter.Copy((int64)MatchingBlock * BlockSize, BlockSize);
+
+			Pos += BlockSize;
+			LiteralStart = Pos;
+			bWindowHashValid = false;
+		}
+		else
+		{
+			if (Pos + BlockSize < BufferEnd)
+			{
+				WindowHash.Roll(Buffer[Pos], Buffer[Pos + BlockSize]);
+			}
+			else
+			{
+				bWindowHashValid = false;
+			}
+			++Pos;
+		}
+	}
+
+	// Whatever is left is shorter than a block and can't match
+	OpWriter.Insert(Buffer.GetData() + LiteralStart, BufferEnd - LiteralStart);
+	OpWriter.End();
+
+	NewHasher.Final();
+	NewHasher.GetHash(NewHash.Hash);
+
+	Writer->Seek(0);
+	*Writer << HeaderMagic << HeaderVersion << HeaderOldSize << HeaderNewSize << NewHash;
+
+	const int64 DeltaSize = Writer->TotalSize();
+	if (!Writer->Close())
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to write %s"), *DeltaFile);
+		return false;
+	}
+
+	UE_LOG(LogModSupport, Log, TEXT("Created delta %s: %lld bytes for a %lld byte pak"), *FPaths::GetCleanFilename(DeltaFile), DeltaSize, NewSize);
+	return true;
+}
+
+bool FModPakDelta::Apply(const FString& OldPakFile, const FString& DeltaFile, const FString& NewPakFile, FString& OutError)
+{
+	using namespace ModPakDelta;
+
+	TUniquePtr<FArchive> OldReader(IFileManager::Get().CreateFileReader(*OldPakFile));
+	TUniquePtr<FArchive> DeltaReader(IFileManager::Get().CreateFileReader(*DeltaFile));
+	if (!OldReader.IsValid() || !DeltaReader.IsValid())
+	{
+		OutError = FString::Printf(TEXT("Failed to open %s or %s"), *OldPakFile, *DeltaFile);
+		return false;
+	}
+
+	uint32 HeaderMagic = 0;
+	int32 HeaderVersion = 0;
+	int64 OldSize = 0;
+	int64 NewSize = 0;
+	FSHAHash ExpectedHash;
+
+	*DeltaReader << HeaderMagic << HeaderVersion << OldSize << NewSize << ExpectedHash;
+
+	if (DeltaReader->IsError() || HeaderMagic != Magic || HeaderVersion != FormatVersion)
+	{
+		OutError = FString::Printf(TEXT("%s is not a pak delta"), *DeltaFile);
+		return false;
+	}
+
+	if (OldReader->TotalSize() != OldSize)
+	{
+		OutError = FString::Printf(TEXT("%s was created from a different version of %s"), *FPaths::GetCleanFilename(DeltaFile), *FPaths::GetCleanFilename(OldPakFile));
+		return false;
+	}
+
+	const FString TempFile = NewPakFile + TEXT(".tmp");
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFile));
+	if (!Writer.IsValid())
+	{
+		OutError = FString::Printf(TEXT("Failed to create %s"), *TempFile);
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(BufferSize);
+
+	FSHA1 NewHasher;
+	int64 Written = 0;
+	bool bSuccess = true;
+
+	for (;;)
+	{
+		EOp Op = EOp::End;
+		*DeltaReader << Op;
+
+		if (DeltaReader->IsError() || Op == EOp::End)
+		{
+			bSuccess = !DeltaReader->IsError();
+			break;
+		}
+
+		int64 Offset = 0;
+		int64 Length = 0;
+
+		if (Op == EOp::Copy)
+		{
+			*DeltaReader << Offset << Length;
+			if (Offset < 0 || Length < 0 || Offset + Length > OldSize)
+			{
+				bSuccess = false;
+				break;
+			}
+
+			OldReader->Seek(Offset);
+			bSuccess = CopyBytes(*OldReader, *Writer, Length, Buffer, NewHasher);
+		}
+		else if (Op == EOp::Insert)
+		{
+			*DeltaReader << Length;
+			bSuccess = Length >= 0 && CopyBytes(*DeltaReader, *Writer, Length, Buffer, NewHasher);
+		}
+		else
+		{
+			bSuccess = false;
+		}
+
+		if (!bSuccess)
+		{
+			break;
+		}
+
+		Written += Length;
+	}
+
+	// The old pak may be the one about to be replaced
+	OldReader.Reset();
+	DeltaReader.Reset();
+	bSuccess = Writer->Close() && bSuccess;
+	Writer.Reset();
+
+	FSHAHash NewHash;
+	NewHasher.Final();
+	NewHasher.GetHash(NewHash.Hash);
+
+	if (!bSuccess || Written != NewSize || NewHash != ExpectedHash)
+	{
+		IFileManager::Get().Delete(*TempFile, false, true, true);
+		OutError = FString::Printf(TEXT("Applying %s to %s didn't produce the expected pak"), *FPaths::GetCleanFilename(DeltaFile), *FPaths::GetCleanFilename(OldPakFile));
+		return false;
+	}
+
+	if (!IFileManager::Get().Move(*NewPakFile, *TempFile, true, true))
+	{
+		IFileManager::Get().Delete(*TempFile, false, true, true);
+		OutError = FString::Printf(TEXT("Failed to move the new pak to %s"), *NewPakFile);
+		return false;
+	}
+
+	return true;
+}
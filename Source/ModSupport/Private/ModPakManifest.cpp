@@ -0,0 +1,213 @@
+#include "ModPakManifest.h"
+
+#include "ModSupportLog.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+FModPakManifest::FModPakManifest()
+	: BlockSize(4 * 1024 * 1024)
+{
+}
+
+bool FModPakManifest::Build(const TArray<FString>& PakFiles)
+{
+	TArray<FModPakHashes> Hashes;
+	if (!HashPaks(PakFiles, Hashes))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < PakFiles.Num(); ++Index)
+	{
+		Paks.Add(FPaths::GetCleanFilename(PakFiles[Index]), MoveTemp(Hashes[Index]));
+	}
+
+	return true;
+}
+
+bool FModPakManifest::Verify(const TArray<FString>& PakFiles, FString& OutError) const
+{
+	TArray<const FModPakHashes*> ExpectedHashes;
+	for (const FString& PakFile : PakFiles)
+	{
+		const FModPakHashes* Expected = Paks.Find(FPaths::GetCleanFilename(PakFile));
+		if (Expected == nullptr)
+		{
+			OutError = FString::Printf(TEXT("%s is not listed in the pak manifest"), *FPaths::GetCleanFilename(PakFile));
+			return false;
+		}
+
+		// A size mismatch fails without reading the pak at all
+		if (IFileManager::Get().FileSize(*PakFile) != Expected->Size)
+		{
+			OutError = FString::Printf(TEXT("%s has the wrong size"), *FPaths::GetCleanFilename(PakFile));
+			return false;
+		}
+
+		ExpectedHashes.Add(Expected);
+	}
+
+	TArray<FModPakHashes> Hashes;
+	if (!HashPaks(PakFiles, Hashes))
+	{
+		OutError = TEXT("Failed to read the paks");
+		return false;
+	}
+
+	for (int32 Index = 0; Index < PakFiles.Num(); ++Index)
+	{
+		if (Hashes[Index].BlockHashes != ExpectedHashes[Index]->BlockHashes)
+		{
+			OutError = FString::Printf(TEXT("%s doesn't match the pak manifest"), *FPaths::GetCleanFilename(PakFiles[Index]));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FModPakManifest::HashPaks(const TArray<FString>& PakFiles, TArray<FModPakHashes>& OutHashes) const
+{
+	struct FBlock
+	{
+		int32 PakIndex;
+		int32 BlockIndex;
+	};
+
+	OutHashes.Reset();
+	OutHashes.SetNum(PakFiles.Num());
+
+	TArray<FBlock> Blocks;
+	for (int32 PakIndex = 0; PakIndex < PakFiles.Num(); ++PakIndex)
+	{
+		const int64 Size = IFileManager::Get().FileSize(*PakFiles[PakIndex]);
+		if (Size < 0)
+		{
+			return false;
+		}
+
+		const int32 NumBlocks = (int32)FMath::DivideAndRoundUp(Size, BlockSize);
+
+		OutHashes[PakIndex].Size = Size;
+		OutHashes[PakIndex].BlockHashes.SetNumZeroed(NumBlocks);
+
+		for (int32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+		{
+			Blocks.Add({ PakIndex, BlockIndex });
+		}
+	}
+
+	// The blocks of all paks are spread over the workers, so a single big pak doesn't serialize the hashing
+	TAtomic<bool> bAllRead(true);
+	ParallelFor(Blocks.Num(), [this, &PakFiles, &Blocks, &OutHashes, &bAllRead](int32 Index)
+	{
+		const FBlock& Block = Blocks[Index];
+		FModPakHashes& Hashes = OutHashes[Block.PakIndex];
+
+		const int64 Offset = Block.BlockIndex * BlockSize;
+		const int64 Size = FMath::Min(BlockSize, Hashes.Size - Offset);
+
+		TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*PakFiles[Block.PakIndex]));
+		if (!Reader.IsValid())
+		{
+			bAllRead = false;
+			return;
+		}
+
+		TArray<uint8> Buffer;
+		Buffer.SetNumUninitialized(Size);
+
+		Reader->Seek(Offset);
+		Reader->Serialize(Buffer.GetData(), Size);
+
+		if (Reader->IsError())
+		{
+			bAllRead = false;
+			return;
+		}
+
+		Hashes.BlockHashes[Block.BlockIndex] = CityHash64((const char*)Buffer.GetData(), Size);
+	});
+
+	return bAllRead;
+}
+
+bool FModPakManifest::Load(const FString& Filename)
+{
+	Paks.Reset();
+
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *Filename))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to parse pak manifest %s"), *Filename);
+		return false;
+	}
+
+	BlockSize = FCString::Strtoi64(*RootObject->GetStringField(TEXT("blockSize")), nullptr, 10);
+	if (BlockSize <= 0)
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Pak manifest %s has an invalid block size"), *Filename);
+		return false;
+	}
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : RootObject->GetObjectField(TEXT("paks"))->Values)
+	{
+		const TSharedPtr<FJsonObject>& PakObject = Pair.Value->AsObject();
+
+		FModPakHashes& Hashes = Paks.Add(Pair.Key);
+		Hashes.Size = FCString::Strtoi64(*PakObject->GetStringField(TEXT("size")), nullptr, 10);
+
+		// 64 bit values are stored as strings, JSON numbers are doubles
+		for (const TSharedPtr<FJsonValue>& HashValue : PakObject->GetArrayField(TEXT("blocks")))
+		{
+			Hashes.BlockHashes.Add(FCString::Strtoui64(*HashValue->AsString(), nullptr, 16));
+		}
+	}
+
+	return true;
+}
+
+bool FModPakManifest::Save(const FString& Filename) const
+{
+	TSharedRef<FJsonObject> PaksObject = MakeShared<FJsonObject>();
+	for (const TPair<FString, FModPakHashes>& Pair : Paks)
+	{
+		TArray<TSharedPtr<FJsonValue>> HashValues;
+		for (uint64 Hash : Pair.Value.BlockHashes)
+		{
+			HashValues.Add(MakeShared<FJsonValueString>(FString::Printf(TEXT("%016llx"), Hash)));
+		}
+
+		TSharedRef<FJsonObject> PakObject = MakeShared<FJsonObject>();
+		PakObject->SetStringField(TEXT("size"), LexToString(Pair.Value.Size));
+		PakObject->SetArrayField(TEXT("blocks"), HashValues);
+
+		PaksObject->SetObjectField(Pair.Key, PakObject);
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetStringField(TEXT("blockSize"), LexToString(BlockSize));
+	RootObject->SetObjectField(TEXT("paks"), PaksObject);
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *Filename))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to save pak manifest %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+#include "ModSharedContentMap.h"
+
+#include "ModSupportLog.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+bool FModSharedContentMap::Load(const FString& Filename)
+{
+	Redirects.Reset();
+
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *Filename))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid())
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to parse shared content map %s"), *Filename);
+		return false;
+	}
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : RootObject->GetObjectField(TEXT("redirects"))->Values)
+	{
+		Redirects.Add(Pair.Key, Pair.Value->AsString());
+	}
+
+	return true;
+}
+
+bool FModSharedContentMap::Save(const FString& Filename) const
+{
+	TSharedRef<FJsonObject> RedirectsObject = MakeShared<FJsonObject>();
+	for (const TPair<FString, FString>& Pair : Redirects)
+	{
+		RedirectsObject->SetStringField(Pair.Key, Pair.Value);
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetObjectField(TEXT("redirects"), RedirectsObject);
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *Filename))
+	{
+		UE_LOG(LogModSupport, Error, TEXT("Failed to save shared content map %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
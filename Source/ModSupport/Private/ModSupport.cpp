@@ -2,19 +2,155 @@
 
 #include "ModSupport.h"
 
+#include "ModManager.h"
+#include "ModPakDelta.h"
+#include "ModSupportLog.h"
+#include "ModSupportSettings.h"
+#include "CoreGlobals.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
 #define LOCTEXT_NAMESPACE "FModSupportModule"
 
+namespace ModSupport
+{
+	/** Lets dedicated servers pick up an updated mod without dropping their players */
+	static FAutoConsoleCommand ReloadModCommand(
+		TEXT("ModSupport.ReloadMod"),
+		TEXT("Reloads the named mods from their installed version. Usage: ModSupport.ReloadMod <ModName> [<ModName>...]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			for (const FString& ModName : Args)
+			{
+				FModSupportModule::Get().GetModManager().ReloadMod(ModName);
+			}
+		}));
+
+	static FAutoConsoleCommand ListConflictsCommand(
+		TEXT("ModSupport.ListConflicts"),
+		TEXT("Lists every package file shipped by more than one mounted mod, and the mod whose copy is loaded. Requires bDetectPackageConflicts"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FModSupportModule::Get().GetModManager().LogPackageConflicts();
+		}));
+
+	static FAutoConsoleCommand ListMemoryCommand(
+		TEXT("ModSupport.ListMemory"),
+		TEXT("Lists the memory held by the loaded content of every mounted mod"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FModSupportModule::Get().GetModManager().LogMemoryUsage();
+		}));
+
+	static FAutoConsoleCommand EnforceMemoryBudgetCommand(
+		TEXT("ModSupport.EnforceMemoryBudget"),
+		TEXT("Releases the content of inactive mods right away if the mods hold more than the memory budget"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			FModSupportModule::Get().GetModManager().EnforceMemoryBudget();
+		}));
+
+	static FAutoConsoleCommand MarkModUnusedCommand(
+		TEXT("ModSupport.MarkModUnused"),
+		TEXT("Lets the memory budget release the content of a mod once it is inactive. Usage: ModSupport.MarkModUnused <Mod>"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 1)
+			{
+				UE_LOG(LogModSupport, Error, TEXT("Usage: ModSupport.MarkModUnused <Mod>"));
+				return;
+			}
+
+			FModSupportModule::Get().GetModManager().MarkModUnused(Args[0]);
+		}));
+
+	/** Lets pak deltas be created and checked against local files, without packaging or installing a mod */
+	static FAutoConsoleCommand CreatePakDeltaCommand(
+		TEXT("ModSupport.CreatePakDelta"),
+		TEXT("Writes the delta that turns one pak into another. Usage: ModSupport.CreatePakDelta <OldPak> <NewPak> <Delta> [<BlockSize>]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 3)
+			{
+				UE_LOG(LogModSupport, Error, TEXT("Usage: ModSupport.CreatePakDelta <OldPak> <NewPak> <Delta> [<BlockSize>]"));
+				return;
+			}
+
+			const int32 BlockSize = Args.IsValidIndex(3) ? FCString::Atoi(*Args[3]) : 64 * 1024;
+			FModPakDelta::Create(Args[0], Args[1], Args[2], FMath::Clamp(BlockSize, 1024, 1024 * 1024));
+		}));
+
+	static FAutoConsoleCommand ApplyPakDeltaCommand(
+		TEXT("ModSupport.ApplyPakDelta"),
+		TEXT("Applies a pak delta. Usage: ModSupport.ApplyPakDelta <OldPak> <Delta> <NewPak>"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() < 3)
+			{
+				UE_LOG(LogModSupport, Error, TEXT("Usage: ModSupport.ApplyPakDelta <OldPak> <Delta> <NewPak>"));
+				return;
+			}
+
+			FString Error;
+			if (FModPakDelta::Apply(Args[0], Args[1], Args[2], Error))
+			{
+				UE_LOG(LogModSupport, Display, TEXT("Wrote %s"), *Args[2]);
+			}
+			else
+			{
+				UE_LOG(LogModSupport, Error, TEXT("%s"), *Error);
+			}
+		}));
+}
+
 void FModSupportModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	ModManager = MakeShared<FModManager>();
+
+	// The editor and its commandlets load the mods in the mods directory as source plugins, so mounting them again
+	// would put mount points of editor plugins under the control of the mod manager
+	if (GetDefault<UModSupportSettings>()->bMountModsOnStartup && !GIsEditor && !IsRunningCommandlet())
+	{
+		ModManager->DiscoverMods();
+		ModManager->MountModsAsync();
+	}
+
+	if (GetDefault<UModSupportSettings>()->bWriteLoadTimingReport)
+	{
+		EngineInitCompleteHandle = FCoreDelegates::OnFEngineLoopInitComplete.AddRaw(this, &FModSupportModule::HandleEngineInitComplete);
+	}
 }
 
 void FModSupportModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	FCoreDelegates::OnFEngineLoopInitComplete.Remove(EngineInitCompleteHandle);
+
+	ModManager.Reset();
+}
+
+FModSupportModule& FModSupportModule::Get()
+{
+	return FModuleManager::LoadModuleChecked<FModSupportModule>(TEXT("ModSupport"));
+}
+
+FModManager& FModSupportModule::GetModManager() const
+{
+	check(ModManager.IsValid());
+	return *ModManager;
+}
+
+void FModSupportModule::HandleEngineInitComplete()
+{
+	// The report covers the whole startup, so mods still mounting in the background have to finish first
+	ModManager->WaitForPendingMounts();
+	ModManager->GetLoadTimings().WriteReport(FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModLoadTimings.json"));
 }
 
 #undef LOCTEXT_NAMESPACE
 	
-IMPLEMENT_MODULE(FModSupportModule, ModSupport)
\ No newline at end of file
+IMPLEMENT_MODULE(FModSupportModule, ModSupport)
@@ -0,0 +1,19 @@
+#include "ModSupportSettings.h"
+
+UModSupportSettings::UModSupportSettings()
+	: bMountModsOnStartup(true)
+	, ModsDirectory(TEXT("Mods"))
+	, bUseManifestCache(true)
+	, PakReadOrder(4)
+	, bMountOnDemand(false)
+	, bVerifyPaks(false)
+	, bMergeAssetRegistry(true)
+	, bEnableMemoryBudget(false)
+	, MemoryBudgetMB(1024)
+	, ModInactiveSeconds(300.0f)
+	, MemoryBudgetCheckInterval(30.0f)
+	, bWriteLoadTimingReport(false)
+	, bRecordLoadOrder(false)
+	, bDetectPackageConflicts(false)
+{
+}
@@ -0,0 +1,92 @@
+#include "ModSupportStats.h"
+
+#include "ModSupportLog.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace ModSupportStats
+{
+	static const TCHAR* GetPhaseName(EModLoadPhase Phase)
+	{
+		switch (Phase)
+		{
+		case EModLoadPhase::Discover:			return TEXT("Discover");
+		case EModLoadPhase::Verify:				return TEXT("Verify");
+		case EModLoadPhase::Mount:				return TEXT("Mount");
+		case EModLoadPhase::RegisterAssets:		return TEXT("RegisterAssets");
+		case EModLoadPhase::FirstPackageLoad:	return TEXT("FirstPackageLoad");
+		default:								return TEXT("Unknown");
+		}
+	}
+}
+
+void FModLoadTimings::Add(const FString& ModName, EModLoadPhase Phase, double Seconds)
+{
+	FScopeLock Lock(&TimingsCritical);
+
+	TArray<double, TFixedAllocator<(int32)EModLoadPhase::Num>>* ModTimings = Timings.Find(ModName);
+	if (ModTimings == nullptr)
+	{
+		ModTimings = &Timings.Add(ModName);
+		ModTimings->SetNumZeroed((int32)EModLoadPhase::Num);
+	}
+
+	(*ModTimings)[(int32)Phase] += Seconds;
+}
+
+bool FModLoadTimings::WriteReport(const FString& Filename) const
+{
+	TArray<TSharedPtr<FJsonValue>> ModValues;
+	{
+		FScopeLock Lock(&TimingsCritical);
+
+		for (const auto& Pair : Timings)
+		{
+			TSharedRef<FJsonObject> ModObject = MakeShared<FJsonObject>();
+			ModObject->SetStringField(TEXT("name"), Pair.Key);
+
+			for (int32 Phase = 0; Phase < (int32)EModLoadPhase::Num; ++Phase)
+			{
+				ModObject->SetNumberField(FString(ModSupportStats::GetPhaseName((EModLoadPhase)Phase)) + TEXT("Ms"), Pair.Value[Phase] * 1000.0);
+			}
+
+			ModValues.Add(MakeShared<FJsonValueObject>(ModObject));
+		}
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetArrayField(TEXT("mods"), ModValues);
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *Filename))
+	{
+		UE_LOG(LogModSupport, Warning, TEXT("Failed to write mod load timings to %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogModSupport, Log, TEXT("Wrote mod load timings to %s"), *Filename);
+	return true;
+}
+
+FModLoadPhaseScope::FModLoadPhaseScope(FModLoadTimings& InTimings, const FString& InModName, EModLoadPhase InPhase)
+	: Timings(InTimings)
+	, ModName(InModName)
+	, Phase(InPhase)
+	, StartTime(FPlatformTime::Seconds())
+{
+#if ENABLE_NAMED_EVENTS
+	FPlatformMisc::BeginNamedEvent(FColor::Emerald, *FString::Printf(TEXT("Mod %s %s"), *ModName, ModSupportStats::GetPhaseName(Phase)));
+#endif
+}
+
+FModLoadPhaseScope::~FModLoadPhaseScope()
+{
+#if ENABLE_NAMED_EVENTS
+	FPlatformMisc::EndNamedEvent();
+#endif
+
+	Timings.Add(ModName, Phase, FPlatformTime::Seconds() - StartTime);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModInfo.h"
+#include "ModCatalog.generated.h"
+
+/** How a catalog query treats one of the flags of the mods */
+UENUM(BlueprintType)
+enum class EModCatalogFlagFilter : uint8
+{
+	/** Mods match whether the flag is set or not */
+	Any,
+	/** Only mods with the flag set match */
+	Only,
+	/** Only mods without the flag set match */
+	Exclude,
+};
+
+/** Filters and page of a mod catalog query. Empty filters match every mod */
+USTRUCT(BlueprintType, Category = "ModSupport|Catalog")
+struct MODSUPPORT_API FModCatalogQuery
+{
+	GENERATED_BODY()
+
+	/** Category the mods must have, ignoring case */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	FString Category;
+
+	/** Author the mods must have, ignoring case */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	FString CreatedBy;
+
+	/** Prefix of the name or the friendly name of the mods, ignoring case */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	FString NamePrefix;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	EModCatalogFlagFilter Beta = EModCatalogFlagFilter::Any;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	EModCatalogFlagFilter Experimental = EModCatalogFlagFilter::Any;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog")
+	EModCatalogFlagFilter Hidden = EModCatalogFlagFilter::Exclude;
+
+	/** Page of the matching mods to return, starting at 0 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog", meta = (ClampMin = "0"))
+	int32 PageIndex = 0;
+
+	/** Maximum number of mods on a page */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ModSupport|Catalog", meta = (ClampMin = "1"))
+	int32 PageSize = 50;
+};
+
+/** One page of the mods matching a catalog query, ordered by name */
+USTRUCT(BlueprintType, Category = "ModSupport|Catalog")
+struct MODSUPPORT_API FModCatalogPage
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|Catalog")
+	TArray<FModInfo> Mods;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|Catalog")
+	int32 PageIndex = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|Catalog")
+	int32 NumPages = 0;
+
+	/** Number of mods matching the query over all pages */
+	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|Catalog")
+	int32 TotalCount = 0;
+};
+
+/**
+ * Indexed store of the installed mods for mod browsers. The mods are kept sorted by name, and indexed by category,
+ * author and flags. A query walks the smallest index that applies to it and checks the other filters against the
+ * mods found there, so filtering costs as much as the most selective filter matches rather than all installed mods.
+ * Name prefixes are looked up by binary search over the mods sorted by name and by friendly name.
+ */
+class MODSUPPORT_API FModCatalog
+{
+public:
+
+	/** Replaces the mods in the catalog and rebuilds every index */
+	void Reset(TArray<FModInfo> InMods);
+
+	/** Gets a page of the mods matching a query */
+	void Query(const FModCatalogQuery& Query, FModCatalogPage& OutPage) const;
+
+	/** @return The number of mods matching a query, ignoring its page */
+	int32 Count(const FModCatalogQuery& Query) const;
+
+	/** @return The named mod, or nullptr if it isn't in the catalog */
+	const FModInfo* Find(const FString& Name) const;
+
+	/** Gets the categories of the mods in the catalog, sorted */
+	void GetCategories(TArray<FString>& OutCategories) const;
+
+	/** Gets the authors of the mods in the catalog, sorted */
+	void GetAuthors(TArray<FString>& OutAuthors) const;
+
+	int32 Num() const { return Mods.Num(); }
+
+private:
+
+	/** Calls the visitor with the index of every mod matching the query, in name order */
+	void ForEachMatch(const FModCatalogQuery& Query, TFunctionRef<void(int32 /* ModIndex */)> Visitor) const;
+
+	/** Gets the mods whose name or friendly name starts with the prefix, in name order */
+	void FindByPrefix(const FString& Prefix, TArray<int32>& OutModIndices) const;
+
+	/** Installed mods, sorted by name */
+	TArray<FModInfo> Mods;
+
+	/** Indices of the mods sorted by friendly name */
+	TArray<int32> FriendlyNameOrder;
+
+	/** Index of every mod by name */
+	TMap<FString, int32> NameIndex;
+
+	/** Indices of the mods of each category and author, in name order. FString keys ignore case */
+	TMap<FString, TArray<int32>> CategoryIndex;
+	TMap<FString, TArray<int32>> CreatedByIndex;
+
+	/** Indices of the mods with each flag set, in name order */
+	TArray<int32> BetaMods;
+	TArray<int32> ExperimentalMods;
+	TArray<int32> HiddenMods;
+};
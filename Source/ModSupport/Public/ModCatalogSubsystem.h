@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModCatalog.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "ModCatalogSubsystem.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnModCatalogChanged);
+
+/**
+ * Catalog of the installed mods for game code and mod browsers. The catalog follows the mods found and mounted by
+ * the mod manager, and is rebuilt by the first query after they changed.
+ */
+UCLASS()
+class MODSUPPORT_API UModCatalogSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** USubsystem implementation */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Gets a page of the installed mods matching a query, ordered by name */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	FModCatalogPage QueryMods(const FModCatalogQuery& Query) const;
+
+	/** @return The number of installed mods matching a query, ignoring its page */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	int32 CountMods(const FModCatalogQuery& Query) const;
+
+	/** Gets the info of an installed mod by name */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	bool FindMod(const FString& Name, FModInfo& OutModInfo) const;
+
+	/** @return The categories of the installed mods, sorted */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	TArray<FString> GetCategories() const;
+
+	/** @return The authors of the installed mods, sorted */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	TArray<FString> GetAuthors() const;
+
+	/** @return The number of installed mods */
+	UFUNCTION(BlueprintCallable, Category = "ModSupport|Catalog")
+	int32 GetNumMods() const;
+
+	/** @return The catalog, up to date with the installed mods */
+	const FModCatalog& GetCatalog() const;
+
+	/** Broadcast whenever mods were found, mounted or reloaded, so results shown from the catalog can be queried again */
+	UPROPERTY(BlueprintAssignable, Category = "ModSupport|Catalog")
+	FOnModCatalogChanged OnCatalogChanged;
+
+private:
+
+	/** Rebuilds the catalog on the next query */
+	void MarkDirty();
+
+	mutable FModCatalog Catalog;
+
+	mutable bool bDirty = true;
+
+	FDelegateHandle ModsDiscoveredHandle;
+	FDelegateHandle ModMountedHandle;
+	FDelegateHandle ModReloadedHandle;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** An optional chunk of a mod, a pak that is only mounted once one of its packages is loaded */
+struct FModChunk
+{
+	/** Filename of the chunk's pak, relative to the chunk map */
+	FString PakFile;
+
+	/** Long names of the packages in the chunk */
+	TArray<FString> Packages;
+
+	friend FArchive& operator<<(FArchive& Ar, FModChunk& Chunk)
+	{
+		return Ar << Chunk.PakFile << Chunk.Packages;
+	}
+};
+
+/**
+ * Lists the optional chunks a mod was split into by the packager. It ships next to the mod's paks; every pak that
+ * isn't listed belongs to the core of the mod, which is always mounted.
+ */
+class MODSUPPORT_API FModChunkMap
+{
+public:
+
+	/** @return The filename of the chunk map within the pak directory of a mod */
+	static const TCHAR* GetFilename() { return TEXT("ModChunks.json"); }
+
+	/** @return The name of the pak holding the given chunk of a mod */
+	static FString GetPakFilename(const FString& ModName, const FString& ChunkName);
+
+	bool Load(const FString& Filename);
+	bool Save(const FString& Filename) const;
+
+	TArray<FModChunk> Chunks;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Orders mods by the plugins they require. Mods are grouped into waves: every mod in a wave only
+ * depends on mods of earlier waves, so the mods of one wave can be mounted in parallel.
+ */
+class MODSUPPORT_API FModDependencyResolver
+{
+public:
+
+	/** Adds a mod to the graph, along with the names of the plugins and mods it requires */
+	void AddMod(const FString& Name, const TArray<FString>& PluginsRequire);
+
+	/**
+	 * Builds the waves of all added mods and finds the mods that cannot be loaded at all.
+	 *
+	 * @param	IsPluginAvailable	Tells if a required plugin that is not one of the added mods is available, e.g. an enabled game plugin
+	 * @return	True if every mod could be scheduled
+	 */
+	bool Resolve(TFunctionRef<bool(const FString& /* PluginName */)> IsPluginAvailable);
+
+	/** @return The mods grouped into waves, in the order they have to be mounted */
+	const TArray<TArray<FString>>& GetWaves() const { return Waves; }
+
+	/** @return The mods that cannot be loaded, mapped to the reason why */
+	const TMap<FString, FString>& GetUnloadableMods() const { return UnloadableMods; }
+
+private:
+
+	/** The plugins required by each added mod */
+	TMap<FString, TArray<FString>> Dependencies;
+
+	TArray<TArray<FString>> Waves;
+
+	TMap<FString, FString> UnloadableMods;
+};
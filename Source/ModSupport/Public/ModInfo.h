@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "ModInfo.generated.h"
 
+struct FPluginDescriptor;
+
 USTRUCT(BlueprintType, Category = "ModSupport|ModInfo")
 struct MODSUPPORT_API FModInfo
 {
@@ -18,7 +20,7 @@ struct MODSUPPORT_API FModInfo
 	FString VirtualMountPoint;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
-	int32 Version;
+	int32 Version = 0;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
 	FString VersionName;
@@ -54,14 +56,20 @@ struct MODSUPPORT_API FModInfo
 	FString ParentPluginName;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
-	bool bIsBetaVersion;
+	bool bIsBetaVersion = false;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
-	bool bIsExperimentalVersion;
+	bool bIsExperimentalVersion = false;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
-	bool bIsHidden;
+	bool bIsHidden = false;
 
 	UPROPERTY(BlueprintReadOnly, Category = "ModSupport|ModInfo")
 	TArray<FString> PluginsRequire;
+
+	/** Copies the descriptor fields of a mod, leaving its mount information untouched */
+	void SetDescriptor(const FString& InName, const FPluginDescriptor& Descriptor);
+
+	/** Serializes every field in a compact binary form, used by the mod manifest cache */
+	friend MODSUPPORT_API FArchive& operator<<(FArchive& Ar, FModInfo& Info);
 };
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Records the order in which the packages of each mod are first loaded during a session. The packager
+ * turns the recorded order into a pak file order, so reading a mod's pak becomes mostly sequential.
+ */
+class MODSUPPORT_API FModLoadOrderRecorder
+{
+public:
+
+	FModLoadOrderRecorder();
+	~FModLoadOrderRecorder();
+
+	/** Starts recording the loads of a mod's packages */
+	void AddMod(const FString& ModName);
+
+	/**
+	 * Writes the recorded order of every mod. Packages already listed by an earlier session keep their
+	 * place and newly loaded ones are appended, so several sessions add up to one order.
+	 */
+	void Save() const;
+
+	/** @return The file holding the recorded load order of a mod, one package name per line */
+	static FString GetLoadOrderFilename(const FString& ModName);
+
+private:
+
+	void HandlePackageLoad(const FString& PackageName);
+
+private:
+
+	/** The packages of every recorded mod in the order they were first loaded, by mod name */
+	TMap<FString, TArray<FString>> LoadOrders;
+
+	TSet<FString> LoadedPackages;
+
+	mutable FCriticalSection LoadOrdersCritical;
+
+	FDelegateHandle SyncLoadPackageHandle;
+	FDelegateHandle AsyncLoadPackageHandle;
+};
@@ -0,0 +1,392 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModChunkMap.h"
+#include "ModInfo.h"
+#include "ModPackageIndex.h"
+#include "ModSupportStats.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
+#include "UObject/CoreRedirects.h"
+
+class FModManifestCache;
+class FPakPlatformFile;
+class UPackage;
+
+/** Mount state of a single mod */
+enum class EModState : uint8
+{
+	Discovered,
+	Mounting,
+	/** The mount point is registered, the paks are mounted on the first load of one of its packages */
+	Registered,
+	Mounted,
+	Failed,
+};
+
+/** Everything the mod manager tracks about a single installed mod */
+struct FModRecord
+{
+	FModInfo Info;
+
+	/** Directory holding the mod's descriptor and content */
+	FString BaseDir;
+
+	/** Absolute filenames of the paks shipped with the mod, except for its optional chunks */
+	TArray<FString> PakFiles;
+
+	/** Optional chunks of the mod, with absolute pak filenames. Each is mounted on the first load of one of its packages */
+	TArray<FModChunk> OptionalChunks;
+
+	EModState State = EModState::Discovered;
+};
+
+/** Memory held by the loaded packages of a mod */
+struct FModMemoryUsage
+{
+	FString ModName;
+
+	int32 NumPackages = 0;
+	int32 NumObjects = 0;
+
+	/** Size of the loaded objects themselves */
+	int64 ObjectBytes = 0;
+
+	/** Size of the resources owned by the loaded objects, such as texture and mesh data */
+	int64 ResourceBytes = 0;
+
+	/** FPlatformTime::Seconds() of the last load of one of the mod's packages */
+	double LastUsedTime = 0.0;
+
+	int64 GetTotalBytes() const { return ObjectBytes + ResourceBytes; }
+};
+
+DECLARE_MULTICAST_DELEGATE(FOnModsDiscovered);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnModMounted, const FModInfo& /* ModInfo */, bool /* bSuccess */);
+DECLARE_MULTICAST_DELEGATE(FOnAllModsMounted);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnModReloaded, const FModInfo& /* OldModInfo */, const FModInfo& /* NewModInfo */, bool /* bSuccess */);
+
+class MODSUPPORT_API FModManager : public TSharedFromThis<FModManager>
+{
+public:
+
+	FModManager();
+	~FModManager();
+
+	/**
+	 * Finds every installed mod and the paks it ships. Mods that are already mounted are kept as they are.
+	 * Descriptors are read through the manifest cache, so only new or changed descriptors are parsed.
+	 */
+	void DiscoverMods();
+
+	/** @return The absolute directory searched for installed mods */
+	static FString GetModsDir();
+
+	/**
+	 * Gets the root of the mount point a package lives in, which for a mod is the mod name
+	 *
+	 * @param	PackageName		A long package name or object path, e.g. /MyMod/Maps/Level
+	 * @param	OutRoot			Receives the root of the mount point, e.g. MyMod
+	 * @return	False if the name doesn't start with a mount point
+	 */
+	static bool GetMountPointRoot(const FString& PackageName, FString& OutRoot);
+
+	/** @return The filename of the cache holding the parsed mod descriptors, unless another one was set */
+	static FString GetDefaultManifestCacheFilename();
+
+	/** @return The filename of the cache DiscoverMods reads and writes the parsed mod descriptors to */
+	const FString& GetManifestCacheFilename() const { return ManifestCacheFilename; }
+
+	/** Makes DiscoverMods use another manifest cache, e.g. to keep mods that aren't installed out of the real one */
+	void SetManifestCacheFilename(const FString& Filename) { ManifestCacheFilename = Filename; }
+
+	/** @return The filename of the asset registry of a mod within its pak directory */
+	static const TCHAR* GetAssetRegistryFilename() { return TEXT("ModAssetRegistry.bin"); }
+
+	/**
+	 * Mounts the paks of all discovered mods on the thread pool.
+	 * Mods are mounted in waves ordered by their PluginsRequire, every wave mounting in parallel, see FModDependencyResolver.
+	 * Mods with missing or cyclic dependencies fail up front. Completion of every mod, and of the whole batch, is reported on the game thread.
+	 * In on-demand mode the mods are only registered, and each one is updated, verified and mounted on the first load of one of its packages.
+	 */
+	void MountModsAsync();
+
+	/** Blocks the game thread until all pending mounts have finished and their completion events were broadcast */
+	void WaitForPendingMounts();
+
+	/**
+	 * Replaces a mounted mod with the version currently installed, without restarting the process. The loaded packages of
+	 * the mod are released, its paks unmounted, and its descriptor and paks read and mounted again. Only the packages
+	 * and paks of the one mod are touched, apart from the garbage collection that releases them. Game thread only.
+	 *
+	 * @param	Name	The mod to reload
+	 * @return	True if the new version of the mod was mounted
+	 */
+	bool ReloadMod(const FString& Name);
+
+	/**
+	 * Releases the loaded packages of every mounted or registered mod, unmounts its paks and removes its mount point
+	 * and package redirects. Mods of a running batch finish mounting first. Game thread only.
+	 */
+	void UnmountMods();
+
+	/** @return True while any mod is still being mounted */
+	bool IsMounting() const { return PendingMounts > 0; }
+
+	/** @return The record of the named mod, or nullptr if no such mod was discovered */
+	const FModRecord* FindMod(const FString& Name) const;
+
+	/** Gets the info of every discovered mod */
+	void GetMods(TArray<FModInfo>& OutMods) const;
+
+	/** @return The package files of every mounted mod, if package conflict detection is enabled */
+	const FModPackageIndex& GetPackageIndex() const { return PackageIndex; }
+
+	/** Logs every package file provided by more than one mounted mod */
+	void LogPackageConflicts() const;
+
+	/**
+	 * Measures the memory held by every mounted mod. Loaded objects are attributed to a mod by the mount point
+	 * their package lives in. Walks every loaded package, game thread only.
+	 */
+	void GetMemoryUsage(TArray<FModMemoryUsage>& OutUsage) const;
+
+	/** Logs the memory held by every mounted mod, largest first */
+	void LogMemoryUsage() const;
+
+	/**
+	 * Releases the content of the least recently used inactive mods while all mods together hold more than the
+	 * memory budget, then collects garbage once. Called periodically if the memory budget is enabled. Game thread only.
+	 *
+	 * @return	The number of mods whose content was released
+	 */
+	int32 EnforceMemoryBudget();
+
+	/**
+	 * Lets the memory budget release the content of a mod once it is inactive. Mods count as in use until the game
+	 * marks them unused, and loading one of their packages marks them in use again. Game thread only.
+	 */
+	void MarkModUnused(const FString& Name);
+
+	/** @return The time every mod spent in each phase of its lifecycle so far */
+	const FModLoadTimings& GetLoadTimings() const { return LoadTimings; }
+
+	/** Broadcast whenever DiscoverMods finished looking for installed mods */
+	FOnModsDiscovered& OnModsDiscovered() { return ModsDiscoveredEvent; }
+
+	/** Broadcast on the game thread whenever a mod finished mounting */
+	FOnModMounted& OnModMounted() { return ModMountedEvent; }
+
+	/** Broadcast on the game thread once every mod of a batch started by MountModsAsync was mounted or registered for on-demand mounting */
+	FOnAllModsMounted& OnAllModsMounted() { return AllModsMountedEvent; }
+
+	/** Broadcast on the game thread whenever a mod was reloaded, with its info before and after */
+	FOnModReloaded& OnModReloaded() { return ModReloadedEvent; }
+
+private:
+
+	struct FOnDemandMod;
+
+	/** Adds or refreshes the record of a discovered mod. Its pak manifest and chunk map are read through the manifest cache, if one is given */
+	void AddDiscoveredMod(const FModInfo& Info, const FString& BaseDir, FModManifestCache* ManifestCache);
+
+	/** Updates the paks of a mod from the deltas installed next to them, and removes every delta that was applied. Safe to call from any thread */
+	static void ApplyPakDeltas(const FString& ModName, const FString& PakDir);
+
+	/** Gets the pak platform file, creating and installing it if the game was started without paks */
+	FPakPlatformFile* GetPakPlatformFile();
+
+
+	/** Starts mounting the mods of the next pending wave */
+	void StartNextWave();
+
+	/**
+	 * Starts updating the paks of a mod from their deltas on the thread pool, then verifying them if pak verification is enabled.
+	 * Safe to call from any thread.
+	 *
+	 * @return	Whether the paks can be mounted, invalid if there are no paks
+	 */
+	static TSharedFuture<bool> StartPakVerification(const FString& Name, const TArray<FString>& PakFiles, FModLoadTimings& Timings);
+
+	/** Checks the given paks of a mod against the pak manifest next to them. Safe to call from any thread */
+	static bool VerifyPaks(const FString& ModName, const TArray<FString>& PakFiles, FModLoadTimings& Timings);
+
+	/** Reads the package files of the given paks if package conflict detection is enabled. Safe to call from any thread */
+	static void ReadPackageFilenames(const TArray<FString>& PakFiles, TArray<FName>& OutFilenames);
+
+	/** Adds package files of a mounted mod to the package index and warns about new conflicts. Game thread only */
+	void IndexPackages(const FString& Name, TArray<FName> Filenames);
+
+	/** Mounts the given paks. Safe to call from any thread */
+	static bool MountPaks(FPakPlatformFile* PakPlatformFile, const FString& ModName, const TArray<FString>& PakFiles, int32 PakReadOrder, FModLoadTimings& Timings);
+
+	/** Completes a mod mounted by a wave and starts the next wave once all of its mods completed. Game thread only */
+	void HandleModMounted(const FString& Name, bool bSuccess);
+
+	/** Registers the content of a mounted mod and broadcasts its completion. Game thread only */
+	void CompleteMount(const FString& Name, bool bSuccess);
+
+	/** Fills in the mount information of a mod and registers its mount point. Game thread only */
+	void RegisterMountPoint(FModRecord& Record);
+
+	/**
+	 * Merges the asset registry shipped with a mod into the global asset registry, if it has one. Its assets are
+	 * removed again by the asset registry once the mount point of the mod is unregistered. Game thread only.
+	 */
+	void MergeAssetRegistry(const FModRecord& Record);
+
+	/** Redirects the packages the packager left out of a mod to the required mods shipping them, see FModSharedContentMap. Game thread only */
+	void AddSharedContentRedirects(const FModRecord& Record);
+
+	/** Opens the shader code library a mod was packaged with, if it has one. Requires OnDemandCritical */
+	void OpenShaderLibrary_Locked(const FString& Name, const FString& ContentDir);
+
+	/** Registers the mods of the given waves for on-demand mounting */
+	void RegisterModsOnDemand(const TArray<TArray<FString>>& Waves);
+
+	/** Mounts the mod owning the package if it was only registered so far, and records that the mod was used. Called from any thread that loads a package */
+	void HandlePackageLoad(const FString& PackageName);
+
+	/**
+	 * Takes a registered mod and the registered mods it depends on for the calling thread to mount, dependencies first,
+	 * and starts verifying their paks. Requires OnDemandCritical.
+	 *
+	 * @return	Completes once the mod mounted, also if another thread is mounting it. Invalid if the mod is mounted already
+	 */
+	TSharedFuture<bool> ClaimOnDemandMod_Locked(const FString& Root, TArray<FOnDemandMod>& OutModsToMount);
+
+	/** Mounts a mod taken by ClaimOnDemandMod_Locked once its dependencies and its pak verification completed. Must not hold OnDemandCritical */
+	void MountOnDemand(const FOnDemandMod& Mod);
+
+	/** Binds HandlePackageLoad to package loads, if it isn't bound already */
+	void BindPackageLoadDelegates();
+
+	/** Makes the optional chunks of a mod that is about to be mounted mount on demand. Requires OnDemandCritical */
+	void RegisterOptionalChunks_Locked(const FModRecord& Record, const TArray<FString>& MountedPaks, int32 PakReadOrder);
+
+	/** Mounts the optional chunk holding the package, if it isn't mounted yet. Requires OnDemandCritical */
+	void MountOptionalChunk_Locked(const FString& PackageName);
+
+	/** Gets the loaded packages of every mounted mod, by mod name. Game thread only */
+	void GetLoadedModPackages(TMap<FString, TArray<UPackage*>>& OutPackages) const;
+
+	/** Lets go of every object of a package that is only kept alive by being standalone, once garbage is collected */
+	static void ClearStandaloneFlags(UPackage* Package);
+
+	/** Checks the memory held by the mods against the budget. Registered with the core ticker if the memory budget is enabled */
+	bool HandleMemoryBudgetTick(float DeltaTime);
+
+	/** Measures the memory held by the mods again if packages were loaded or garbage was collected since it was last measured. Game thread only */
+	void UpdateMemoryUsage();
+
+	/** Releases every loaded package of a mod, so it can be loaded again from new paks. Game thread only */
+	void UnloadModPackages(const FModRecord& Record);
+
+	/** Unmounts the paks and optional chunks of a mod and unregisters its mount point. Game thread only */
+	void UnmountMod(FModRecord& Record);
+
+private:
+
+	TMap<FString, FModRecord> Mods;
+
+	FString ManifestCacheFilename;
+
+	FPakPlatformFile* PakPlatformFile;
+
+	/** Number of mods of the current batch that have not reported completion yet */
+	int32 PendingMounts;
+
+	/** Number of mods of the running wave that have not reported completion yet */
+	int32 CurrentWaveMounts;
+
+	/** Waves that are mounted once the running wave completed */
+	TArray<TArray<FString>> PendingWaves;
+
+	/** Worker tasks of the current batch */
+	TArray<TFuture<void>> PendingTasks;
+
+	/** Delta update and verification of the paks of every mod that is waiting to be mounted, by mod name */
+	TMap<FString, TSharedFuture<bool>> PakVerifications;
+
+	/** What is needed to mount a registered mod, kept apart from the records so it can be used from loading threads */
+	struct FOnDemandMod
+	{
+		FString Name;
+		TArray<FString> PakFiles;
+		TArray<FString> PluginsRequire;
+		FString ContentDir;
+		int32 PakReadOrder = 0;
+
+		/** Delta update and verification of the paks, started once the mod is first needed. Invalid if the mod has no paks to mount */
+		TSharedFuture<bool> PakVerification;
+
+		/** Mounts of the required mods that were still registered or mounting when the mod was first needed */
+		TArray<TSharedFuture<bool>> DependencyMounts;
+
+		/** Fulfilled once the mod mounted */
+		TSharedPtr<TPromise<bool>> MountPromise;
+	};
+
+	/** Mods registered for on-demand mounting, indexed by the root of their mount point. This is all a package load has to look at */
+	TMap<FString, FOnDemandMod> OnDemandMods;
+
+	/** Mods a loading thread is mounting on demand, by mod name. Completes with whether the mod mounted */
+	TMap<FString, TSharedFuture<bool>> OnDemandMounts;
+
+	struct FOptionalChunk
+	{
+		FString ModName;
+		FString PakFile;
+		int32 PakReadOrder = 0;
+		bool bMounted = false;
+		bool bVerify = false;
+	};
+
+	/** Optional chunks of the mods mounted so far */
+	TArray<FOptionalChunk> OptionalChunks;
+
+	/** Index into OptionalChunks of every package shipped in an optional chunk */
+	TMap<FName, int32> OptionalChunkPackages;
+
+	/** Mods whose asset registry was merged into the global asset registry */
+	TSet<FString> MergedAssetRegistries;
+
+	/** Package redirects of every mod that ships packages deduplicated against the mods it requires */
+	TMap<FString, TArray<FCoreRedirect>> ModRedirects;
+
+	/** Mods whose shader code library is open */
+	TSet<FString> OpenShaderLibraries;
+
+	/** Last time a package was loaded from each mount point root, if the memory budget is enabled */
+	TMap<FString, double> LastUsedTimes;
+
+	/** Mods the game marked unused and that didn't load a package since, which the memory budget may release */
+	TSet<FString> UnusedMods;
+
+	/** Set whenever a package load may have changed the memory held by the mods */
+	bool bMemoryUsageDirty;
+
+	/** Memory held by every mounted mod when it was last measured, by mod name. Entries are added on mount and removed on unmount */
+	TMap<FString, FModMemoryUsage> CachedMemoryUsage;
+
+	/** Guards the on-demand mods and mounts, the optional chunks, the open shader libraries, the last used times, the unused mods and the memory usage dirty flag, which are used from loading threads */
+	mutable FCriticalSection OnDemandCritical;
+
+	FDelegateHandle SyncLoadPackageHandle;
+	FDelegateHandle AsyncLoadPackageHandle;
+
+	FDelegateHandle MemoryBudgetTickHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+
+	FModLoadTimings LoadTimings;
+
+	FModPackageIndex PackageIndex;
+
+	/** Records the load order of the mounted mods, if enabled */
+	TUniquePtr<class FModLoadOrderRecorder> LoadOrderRecorder;
+
+	FOnModsDiscovered ModsDiscoveredEvent;
+	FOnModMounted ModMountedEvent;
+	FOnAllModsMounted AllModsMountedEvent;
+	FOnModReloaded ModReloadedEvent;
+};
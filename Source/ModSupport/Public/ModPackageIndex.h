@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A package file provided by more than one mod */
+struct FModPackageConflict
+{
+	/** Path of the package file within the virtual file system */
+	FName Filename;
+
+	/** The mod whose copy is loaded */
+	FString Winner;
+
+	/** The mods whose copies are hidden by the winner */
+	TArray<FString> Overridden;
+};
+
+/**
+ * Indexes the package files every mod provides, to find mods that ship a file at the same path and so silently
+ * override each other. Mods are added and removed one at a time, touching only their own files, and the set of
+ * conflicting files is kept up to date on the way, so conflicts are reported without another pass over all mods.
+ */
+class MODSUPPORT_API FModPackageIndex
+{
+public:
+
+	/**
+	 * Adds package files of a mod, next to those it was added with before
+	 *
+	 * @param	ModName		The mod providing the files
+	 * @param	Priority	Read order of the mod's paks. A higher priority wins, equal priorities go to the mod added first
+	 * @param	Filenames	The package files of the mod
+	 * @return	The number of the added files that are provided by another mod as well
+	 */
+	int32 AddMod(const FString& ModName, int32 Priority, TArray<FName> Filenames);
+
+	/** Removes the package files of a mod */
+	void RemoveMod(const FString& ModName);
+
+	/** Gets every file provided by more than one mod, along with the mod that wins it */
+	void GetConflicts(TArray<FModPackageConflict>& OutConflicts) const;
+
+	/** @return The mod whose copy of a file is loaded, or nullptr if no mod provides it */
+	const FString* FindProvider(FName Filename) const;
+
+	/** @return The number of files that are provided by more than one mod */
+	int32 GetNumConflicts() const { return ConflictingFiles.Num(); }
+
+	/** Gets the package files within a pak, as they appear in the virtual file system */
+	static bool ReadPakPackageFilenames(const FString& PakFile, TArray<FName>& OutFilenames);
+
+private:
+
+	/** @return The index of the mod that wins among the given ones */
+	int32 FindWinner(const TArray<int32, TInlineAllocator<1>>& ModIndices) const;
+
+	struct FIndexedMod
+	{
+		FString Name;
+		int32 Priority = 0;
+
+		/** Order the mod was added in, which breaks ties between equal priorities */
+		int32 Sequence = 0;
+
+		TArray<FName> Filenames;
+	};
+
+	/** Indexed mods. Removed mods leave an empty slot behind, so the indices stored in Providers stay valid */
+	TArray<FIndexedMod> IndexedMods;
+	TMap<FString, int32> ModIndices;
+
+	/** Index of every mod providing a file, by filename. Nearly every file has a single provider, which fits inline */
+	TMap<FName, TArray<int32, TInlineAllocator<1>>> Providers;
+
+	TSet<FName> ConflictingFiles;
+
+	int32 NextSequence = 0;
+};
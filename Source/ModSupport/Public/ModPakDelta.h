@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Binary delta between two versions of a pak, so a player updating a mod only downloads what changed.
+ *
+ * The delta is a sequence of operations that either copy a range of the old pak or insert bytes carried by the
+ * delta. Blocks of the old pak are found in the new one with a rolling hash, so content that merely moved is copied
+ * as well. Both creating and applying a delta stream through the paks with buffers of a fixed size, however big
+ * the paks are. The result of applying a delta is checked against the hash of the new pak recorded in the delta.
+ */
+class MODSUPPORT_API FModPakDelta
+{
+public:
+
+	/** @return The extension of a delta file. The delta of Foo.pak is shipped as Foo.pak.moddelta next to it */
+	static const TCHAR* GetExtension() { return TEXT("moddelta"); }
+
+	/**
+	 * Writes the delta that turns one pak into another.
+	 *
+	 * @param	OldPakFile		The pak players already have
+	 * @param	NewPakFile		The pak players should end up with
+	 * @param	DeltaFile		Filename the delta is written to
+	 * @param	BlockSize		Size of the blocks of the old pak that are looked for in the new pak. Smaller blocks find more matches but make a bigger index
+	 * @return	True if the delta was written
+	 */
+	static bool Create(const FString& OldPakFile, const FString& NewPakFile, const FString& DeltaFile, int32 BlockSize = 64 * 1024);
+
+	/**
+	 * Applies a delta to a pak. The new pak is written next to NewPakFile first and only moved in place once it
+	 * matched the delta, so NewPakFile may be the same as OldPakFile.
+	 *
+	 * @param	OldPakFile		The pak the delta was created from
+	 * @param	DeltaFile		The delta to apply
+	 * @param	NewPakFile		Filename the new pak is written to
+	 * @param	OutError		Receives why the delta couldn't be applied
+	 * @return	True if the new pak was written and matches the delta
+	 */
+	static bool Apply(const FString& OldPakFile, const FString& DeltaFile, const FString& NewPakFile, FString& OutError);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Size and block hashes of a single pak */
+struct FModPakHashes
+{
+	int64 Size = 0;
+
+	TArray<uint64> BlockHashes;
+};
+
+/**
+ * Block hashes of the paks of a mod, written by the packager next to the paks. Before a mod is mounted its paks
+ * are hashed again and compared, which catches truncated and corrupted uploads. It is no signature though,
+ * whoever can replace the paks can replace the manifest as well.
+ */
+class MODSUPPORT_API FModPakManifest
+{
+public:
+
+	FModPakManifest();
+
+	/** @return The filename of the manifest within the pak directory of a mod */
+	static const TCHAR* GetFilename() { return TEXT("ModPakHashes.json"); }
+
+	/** Hashes the given paks, replacing the hashes of every pak the manifest held so far */
+	bool Build(const TArray<FString>& PakFiles);
+
+	/**
+	 * Hashes the given paks and compares them with the manifest. The blocks of all paks are hashed in parallel.
+	 *
+	 * @param	PakFiles	Absolute filenames of the paks, which are looked up by their clean filename
+	 * @param	OutError	Receives what didn't match
+	 * @return	True if every pak is listed in the manifest and matches it
+	 */
+	bool Verify(const TArray<FString>& PakFiles, FString& OutError) const;
+
+	bool Load(const FString& Filename);
+	bool Save(const FString& Filename) const;
+
+	/** Size of the hashed blocks, in bytes */
+	int64 BlockSize;
+
+	/** Hashes of every pak, by clean filename */
+	TMap<FString, FModPakHashes> Paks;
+
+private:
+
+	/** Hashes the blocks of the given paks in parallel. Blocks that couldn't be read get no hash and leave OutHashes short */
+	bool HashPaks(const TArray<FString>& PakFiles, TArray<FModPakHashes>& OutHashes) const;
+};
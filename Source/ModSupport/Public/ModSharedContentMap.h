@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Maps packages of a mod that are byte-identical to a package of a mod it requires to that package. The packager
+ * leaves the duplicates out of the mod and ships its map next to its paks, and the mod manager redirects them while
+ * the mod is mounted. The packages they are redirected to keep the name they were cooked with, so they load as is.
+ */
+class MODSUPPORT_API FModSharedContentMap
+{
+public:
+
+	/** @return The filename of the map within the pak directory of a mod */
+	static const TCHAR* GetFilename() { return TEXT("ModShared.json"); }
+
+	bool Load(const FString& Filename);
+	bool Save(const FString& Filename) const;
+
+	/** Package of a required mod every deduplicated package is redirected to, by the name of the deduplicated package */
+	TMap<FString, FString> Redirects;
+};
@@ -5,11 +5,30 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
-class FModSupportModule : public IModuleInterface
+class FModManager;
+
+class MODSUPPORT_API FModSupportModule : public IModuleInterface
 {
 public:
 
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	/** @return The ModSupport module, loading it if necessary */
+	static FModSupportModule& Get();
+
+	/** @return The manager that discovers and mounts the installed mods */
+	FModManager& GetModManager() const;
+
+private:
+
+	/** Writes the mod load timing report at the end of startup */
+	void HandleEngineInitComplete();
+
+private:
+
+	TSharedPtr<FModManager> ModManager;
+
+	FDelegateHandle EngineInitCompleteHandle;
 };
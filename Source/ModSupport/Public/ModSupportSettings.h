@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "ModSupportSettings.generated.h"
+
+UCLASS(config = Game, defaultconfig, meta = (DisplayName = "Mod Support"))
+class MODSUPPORT_API UModSupportSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	UModSupportSettings();
+
+	/** Discover and mount every installed mod when the ModSupport module starts up. Ignored in the editor and commandlets */
+	UPROPERTY(config, EditAnywhere, Category = "Mounting")
+	bool bMountModsOnStartup;
+
+	/**
+	 * Directory searched for installed mods, relative to the project directory. Each mod lives in its own
+	 * sub directory next to its descriptor, e.g. Mods/MyMod/MyMod.uplugin
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Discovery")
+	FString ModsDirectory;
+
+	/** Cache the parsed mod descriptors, pak manifests and chunk maps in Saved/ModInfo so only changed ones are parsed on the next boot */
+	UPROPERTY(config, EditAnywhere, Category = "Discovery")
+	bool bUseManifestCache;
+
+	/** Read order given to mounted mod paks. Paks with a higher order take precedence */
+	UPROPERTY(config, EditAnywhere, Category = "Mounting")
+	int32 PakReadOrder;
+
+	/**
+	 * Only register the mount point of every mod up front, and mount its paks the first time a package
+	 * under that mount point is loaded. Saves file handles, pak index memory and startup time when a
+	 * session only uses a few of the installed mods.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Mounting")
+	bool bMountOnDemand;
+
+	/**
+	 * Check the paks of every mod against the block hashes the packager wrote next to them before mounting them.
+	 * Mods are hashed in the background, and each one mounts as soon as its own paks were verified. In on-demand mode
+	 * a mod is only hashed once it is first needed.
+	 * Mods without a pak manifest fail to mount.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Mounting")
+	bool bVerifyPaks;
+
+	/**
+	 * Merge the asset registry the packager ships next to the paks of every mod into the global asset registry when
+	 * the mod is mounted or registered, so asset queries find the content of the mod without scanning it.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Mounting")
+	bool bMergeAssetRegistry;
+
+	/**
+	 * Release the content of the least recently used mods once the loaded content of all mods exceeds MemoryBudgetMB.
+	 * Only mods the game marked unused with FModManager::MarkModUnused, and none of whose packages were loaded for
+	 * ModInactiveSeconds, are released. Their objects stop being kept alive on their own and are garbage collected,
+	 * unless something else still references them.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Memory")
+	bool bEnableMemoryBudget;
+
+	/** Memory the loaded content of all mods may hold before inactive mods are released */
+	UPROPERTY(config, EditAnywhere, Category = "Memory", meta = (ClampMin = "1", Units = "Megabytes"))
+	int32 MemoryBudgetMB;
+
+	/** Time since the last package load of a mod after which the mod counts as inactive */
+	UPROPERTY(config, EditAnywhere, Category = "Memory", meta = (ClampMin = "0", Units = "Seconds"))
+	float ModInactiveSeconds;
+
+	/** Interval at which the memory held by the mods is checked against the budget */
+	UPROPERTY(config, EditAnywhere, Category = "Memory", meta = (ClampMin = "1", Units = "Seconds"))
+	float MemoryBudgetCheckInterval;
+
+	/** Write the time every mod spent in each phase of its startup to Saved/ModInfo/ModLoadTimings.json once the engine is initialized */
+	UPROPERTY(config, EditAnywhere, Category = "Diagnostics")
+	bool bWriteLoadTimingReport;
+
+	/**
+	 * Record the order in which the packages of every mod are first loaded to Saved/ModInfo/<ModName>/LoadOrder.txt.
+	 * The mod packager lays out the paks of a mod in that order.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Diagnostics")
+	bool bRecordLoadOrder;
+
+	/**
+	 * Index the package files in the paks of every mounted mod and warn about files that several mods provide,
+	 * naming the mod whose copy is loaded. Reads the index of every mod pak a second time.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Diagnostics")
+	bool bDetectPackageConflicts;
+};
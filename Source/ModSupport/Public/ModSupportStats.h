@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/CriticalSection.h"
+
+DECLARE_STATS_GROUP(TEXT("ModSupport"), STATGROUP_ModSupport, STATCAT_Advanced);
+
+/** The phases of a mod's lifecycle that are timed */
+enum class EModLoadPhase : uint8
+{
+	/** Parsing the descriptor and finding the paks */
+	Discover,
+	/** Hashing the paks and checking them against their manifest */
+	Verify,
+	/** Mounting the paks */
+	Mount,
+	/** Registering the mount point of the content */
+	RegisterAssets,
+	/** Mounting a mod on demand while its first package is being loaded */
+	FirstPackageLoad,
+
+	Num
+};
+
+/** Collects the time every mod spent in each phase of its lifecycle. Thread safe */
+class MODSUPPORT_API FModLoadTimings
+{
+public:
+
+	/** Adds time spent by a mod in a phase */
+	void Add(const FString& ModName, EModLoadPhase Phase, double Seconds);
+
+	/** Writes the collected timings as JSON, so regressions can be caught by automated tests */
+	bool WriteReport(const FString& Filename) const;
+
+private:
+
+	TMap<FString, TArray<double, TFixedAllocator<(int32)EModLoadPhase::Num>>> Timings;
+
+	mutable FCriticalSection TimingsCritical;
+};
+
+/**
+ * Times a phase of a single mod. The scope shows up as a named event tagged with the
+ * mod name in Unreal Insights, and its duration is added to the given timings.
+ */
+class MODSUPPORT_API FModLoadPhaseScope
+{
+public:
+
+	FModLoadPhaseScope(FModLoadTimings& InTimings, const FString& InModName, EModLoadPhase InPhase);
+	~FModLoadPhaseScope();
+
+private:
+
+	FModLoadTimings& Timings;
+
+	/** Copied, the scope may be built from a temporary name */
+	FString ModName;
+	EModLoadPhase Phase;
+	double StartTime;
+};
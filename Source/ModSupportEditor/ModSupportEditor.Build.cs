@@ -43,6 +43,11 @@ public class ModSupportEditor : ModuleRules
                 "CoreUObject",
                 "Engine",
                 "PluginBrowser",
+                "AssetRegistry",
+                "DirectoryWatcher",
+                "TargetPlatform",
+                "Json",
+                "PakFileUtilities",
                 "Slate",
                 "SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -0,0 +1,140 @@
+#include "ModBenchmarkCommandlet.h"
+
+#include "ModFarmGenerator.h"
+#include "ModManager.h"
+#include "ModSupportEditorLog.h"
+#include "ModSupportSettings.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Serialization/JsonSerializer.h"
+
+UModBenchmarkCommandlet::UModBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UModBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<int32> Scales = { 10, 100, 1000, 5000 };
+
+	FString ScalesValue;
+	if (FParse::Value(*Params, TEXT("Scales="), ScalesValue))
+	{
+		TArray<FString> ScaleStrings;
+		ScalesValue.ParseIntoArray(ScaleStrings, TEXT("+"));
+
+		Scales.Reset();
+		for (const FString& ScaleString : ScaleStrings)
+		{
+			Scales.Add(FMath::Max(FCString::Atoi(*ScaleString), 1));
+		}
+	}
+
+	FModFarmSettings FarmSettings;
+	FParse::Value(*Params, TEXT("AssetsPerMod="), FarmSettings.AssetsPerMod);
+	FParse::Value(*Params, TEXT("AssetSize="), FarmSettings.AssetSize);
+	FarmSettings.AssetsPerMod = FMath::Max(FarmSettings.AssetsPerMod, 1);
+
+	UModSupportSettings* Settings = GetMutableDefault<UModSupportSettings>();
+	const FString OriginalModsDirectory = Settings->ModsDirectory;
+	const bool bOriginalUseManifestCache = Settings->bUseManifestCache;
+	const bool bOriginalMountOnDemand = Settings->bMountOnDemand;
+
+	Settings->bUseManifestCache = true;
+	Settings->bMountOnDemand = false;
+
+	TArray<TSharedPtr<FJsonValue>> ResultValues;
+	bool bSuccess = true;
+
+	for (int32 Scale : Scales)
+	{
+		// Every scale gets its own farm and mod names, since mount points stay registered for the whole run
+		FarmSettings.NumMods = Scale;
+		FarmSettings.NamePrefix = FString::Printf(TEXT("ModFarm%d"), Scale);
+		Settings->ModsDirectory = TEXT("Saved/ModInfo/ModFarm") / FarmSettings.NamePrefix;
+		FarmSettings.OutputDir = FPaths::ProjectDir() / Settings->ModsDirectory;
+
+		if (!FModFarmGenerator::Generate(FarmSettings))
+		{
+			bSuccess = false;
+			break;
+		}
+
+		// The farm gets a manifest cache of its own, the cache of the real mods is left alone
+		const FString ManifestCacheFilename = FarmSettings.OutputDir / TEXT("ModManifestCache.bin");
+		IFileManager::Get().Delete(*ManifestCacheFilename, false, true, true);
+
+		// Cold discovery parses every descriptor, warm discovery reads them all from the manifest cache
+		TSharedRef<FModManager> ColdModManager = MakeShared<FModManager>();
+		ColdModManager->SetManifestCacheFilename(ManifestCacheFilename);
+
+		double StartTime = FPlatformTime::Seconds();
+		ColdModManager->DiscoverMods();
+		const double ColdDiscoverySeconds = FPlatformTime::Seconds() - StartTime;
+
+		TSharedRef<FModManager> ModManager = MakeShared<FModManager>();
+		ModManager->SetManifestCacheFilename(ManifestCacheFilename);
+
+		StartTime = FPlatformTime::Seconds();
+		ModManager->DiscoverMods();
+		const double WarmDiscoverySeconds = FPlatformTime::Seconds() - StartTime;
+
+		// Mounting covers pak mounting as well as mount point registration, since every farm mod ships a pak
+		StartTime = FPlatformTime::Seconds();
+		ModManager->MountModsAsync();
+		ModManager->WaitForPendingMounts();
+		const double MountSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		UObject* FirstAsset = LoadObject<UObject>(nullptr, *FModFarmGenerator::GetAssetPath(FarmSettings, 0, 0));
+		const double FirstAssetLoadSeconds = FPlatformTime::Seconds() - StartTime;
+
+		if (FirstAsset == nullptr)
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to load the first asset of the %d mod farm"), Scale);
+			bSuccess = false;
+		}
+
+		UE_LOG(LogModSupportEditor, Display, TEXT("%5d mods: discovery %.2f ms, descriptor parsing %.2f ms, mount %.2f ms, first asset load %.2f ms"),
+			Scale, WarmDiscoverySeconds * 1000.0, (ColdDiscoverySeconds - WarmDiscoverySeconds) * 1000.0, MountSeconds * 1000.0, FirstAssetLoadSeconds * 1000.0);
+
+		TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+		ResultObject->SetNumberField(TEXT("mods"), Scale);
+		ResultObject->SetNumberField(TEXT("assetsPerMod"), FarmSettings.AssetsPerMod);
+		ResultObject->SetNumberField(TEXT("assetSize"), FarmSettings.AssetSize);
+		ResultObject->SetNumberField(TEXT("coldDiscoveryMs"), ColdDiscoverySeconds * 1000.0);
+		ResultObject->SetNumberField(TEXT("warmDiscoveryMs"), WarmDiscoverySeconds * 1000.0);
+		ResultObject->SetNumberField(TEXT("descriptorParsingMs"), (ColdDiscoverySeconds - WarmDiscoverySeconds) * 1000.0);
+		ResultObject->SetNumberField(TEXT("mountMs"), MountSeconds * 1000.0);
+		ResultObject->SetNumberField(TEXT("firstAssetLoadMs"), FirstAssetLoadSeconds * 1000.0);
+		ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	Settings->ModsDirectory = OriginalModsDirectory;
+	Settings->bUseManifestCache = bOriginalUseManifestCache;
+	Settings->bMountOnDemand = bOriginalMountOnDemand;
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetArrayField(TEXT("results"), ResultValues);
+
+	const FString ReportFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModBenchmark.json");
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *ReportFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to write %s"), *ReportFilename);
+		return 1;
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Wrote benchmark results to %s"), *ReportFilename);
+
+	return bSuccess ? 0 : 1;
+}
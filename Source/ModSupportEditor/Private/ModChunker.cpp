@@ -0,0 +1,176 @@
+#include "ModChunker.h"
+
+#include "ModLoadOrderRecorder.h"
+#include "ModPackagingSettings.h"
+#include "ModSupportEditorLog.h"
+#include "AssetRegistryModule.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+
+const TCHAR* FModChunker::CoreChunkName = TEXT("Core");
+
+namespace ModChunker
+{
+	static int32 FindCluster(TArray<int32>& Parents, int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	}
+}
+
+bool FModChunker::SplitMod(TSharedRef<IPlugin> Plugin, TArray<FModPackageChunk>& OutChunks)
+{
+	OutChunks.Reset();
+
+	const UModPackagingSettings* Settings = GetDefault<UModPackagingSettings>();
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	FString MountedAssetPath = Plugin->GetMountedAssetPath();
+	MountedAssetPath.RemoveFromEnd(TEXT("/"));
+
+	TArray<FAssetData> AssetDataList;
+	AssetRegistry.GetAssetsByPath(FName(*MountedAssetPath), AssetDataList, true);
+
+	TArray<FName> PackageNames;
+	TMap<FName, int32> PackageIndices;
+	TSet<int32> MapPackages;
+
+	for (const FAssetData& AssetData : AssetDataList)
+	{
+		int32 Index = INDEX_NONE;
+		if (const int32* ExistingIndex = PackageIndices.Find(AssetData.PackageName))
+		{
+			Index = *ExistingIndex;
+		}
+		else
+		{
+			Index = PackageNames.Add(AssetData.PackageName);
+			PackageIndices.Add(AssetData.PackageName, Index);
+		}
+
+		if (AssetData.PackageFlags & PKG_ContainsMap)
+		{
+			MapPackages.Add(Index);
+		}
+	}
+
+	TArray<int64> PackageSizes;
+	PackageSizes.SetNumZeroed(PackageNames.Num());
+
+	int64 ModSize = 0;
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		FString PackageFilename;
+		if (FPackageName::DoesPackageExist(PackageNames[Index].ToString(), nullptr, &PackageFilename))
+		{
+			PackageSizes[Index] = FMath::Max<int64>(IFileManager::Get().FileSize(*PackageFilename), 0);
+			ModSize += PackageSizes[Index];
+		}
+	}
+
+	if (ModSize < int64(Settings->MinChunkingSizeMB) * 1024 * 1024)
+	{
+		return false;
+	}
+
+	// Union the packages of the mod along their hard references. References to other mods stay out, those mods are mounted whole
+	TArray<int32> Parents;
+	Parents.SetNum(PackageNames.Num());
+	for (int32 Index = 0; Index < Parents.Num(); ++Index)
+	{
+		Parents[Index] = Index;
+	}
+
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		TArray<FName> Dependencies;
+		AssetRegistry.GetDependencies(PackageNames[Index], Dependencies, EAssetRegistryDependencyType::Hard);
+
+		for (const FName& Dependency : Dependencies)
+		{
+			if (const int32* DependencyIndex = PackageIndices.Find(Dependency))
+			{
+				Parents[ModChunker::FindCluster(Parents, Index)] = ModChunker::FindCluster(Parents, *DependencyIndex);
+			}
+		}
+	}
+
+	TSet<int32> CoreClusters;
+
+	TArray<FString> LoadOrder;
+	FFileHelper::LoadFileToStringArray(LoadOrder, *FModLoadOrderRecorder::GetLoadOrderFilename(Plugin->GetName()));
+
+	for (const FString& PackageName : LoadOrder)
+	{
+		if (const int32* Index = PackageIndices.Find(FName(*PackageName)))
+		{
+			CoreClusters.Add(ModChunker::FindCluster(Parents, *Index));
+		}
+	}
+
+	if (CoreClusters.Num() == 0)
+	{
+		// Without recorded usage the maps are the entry points of a mod
+		for (int32 Index : MapPackages)
+		{
+			CoreClusters.Add(ModChunker::FindCluster(Parents, Index));
+		}
+	}
+
+	FModPackageChunk CoreChunk;
+	CoreChunk.Name = CoreChunkName;
+
+	TMap<int32, FModPackageChunk> OptionalClusters;
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		const int32 Cluster = ModChunker::FindCluster(Parents, Index);
+
+		FModPackageChunk& Chunk = CoreClusters.Contains(Cluster) ? CoreChunk : OptionalClusters.FindOrAdd(Cluster);
+		Chunk.Packages.Add(PackageNames[Index]);
+		Chunk.Size += PackageSizes[Index];
+	}
+
+	if (OptionalClusters.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<FModPackageChunk> Clusters;
+	OptionalClusters.GenerateValueArray(Clusters);
+	Clusters.Sort([](const FModPackageChunk& A, const FModPackageChunk& B) { return A.Size > B.Size; });
+
+	// First fit decreasing keeps the number of optional chunks close to the minimum
+	const int64 TargetChunkSize = int64(Settings->TargetChunkSizeMB) * 1024 * 1024;
+
+	TArray<FModPackageChunk> OptionalChunks;
+	for (FModPackageChunk& Cluster : Clusters)
+	{
+		FModPackageChunk* Chunk = OptionalChunks.FindByPredicate([&Cluster, TargetChunkSize](const FModPackageChunk& OptionalChunk)
+		{
+			return OptionalChunk.Size + Cluster.Size <= TargetChunkSize;
+		});
+
+		if (Chunk == nullptr)
+		{
+			Chunk = &OptionalChunks.AddDefaulted_GetRef();
+			Chunk->Name = FString::Printf(TEXT("Chunk%d"), OptionalChunks.Num());
+		}
+
+		Chunk->Packages.Append(Cluster.Packages);
+		Chunk->Size += Cluster.Size;
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Split %s into a core chunk of %lld KB and %d optional chunk(s) of %lld KB"),
+		*Plugin->GetName(), CoreChunk.Size / 1024, OptionalChunks.Num(), (ModSize - CoreChunk.Size) / 1024);
+
+	OutChunks.Add(MoveTemp(CoreChunk));
+	OutChunks.Append(MoveTemp(OptionalChunks));
+	return true;
+}
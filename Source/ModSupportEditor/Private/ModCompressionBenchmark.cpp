@@ -0,0 +1,190 @@
+#include "ModCompressionBenchmark.h"
+
+#include "ModPackager.h"
+#include "ModSupportEditorLog.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+
+double FModCompressionBenchmarkResult::GetDecompressionThroughput() const
+{
+	return DecompressSeconds > 0.0 ? UncompressedSize / (1024.0 * 1024.0) / DecompressSeconds : 0.0;
+}
+
+bool FModCompressionBenchmark::Run(TSharedRef<IPlugin> Plugin, const FString& TargetPlatform, TArray<FModCompressionBenchmarkResult>& OutResults)
+{
+	OutResults.Reset();
+
+	const UModPackagingSettings* Settings = GetDefault<UModPackagingSettings>();
+
+	TArray<TArray<uint8>> Files;
+	GatherSample(Plugin, TargetPlatform, Settings->BenchmarkSampleSize, Files);
+
+	if (Files.Num() == 0)
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("%s has no assets to benchmark compression with"), *Plugin->GetName());
+		return false;
+	}
+
+	const FModCompressionProfile& CurrentProfile = Settings->GetCompressionProfile(Plugin->GetName());
+
+	for (const FName& CompressionFormat : Settings->BenchmarkCompressionFormats)
+	{
+		if (!FCompression::IsFormatValid(CompressionFormat))
+		{
+			UE_LOG(LogModSupportEditor, Warning, TEXT("Skipping unknown compression format %s"), *CompressionFormat.ToString());
+			continue;
+		}
+
+		for (int32 CompressionBlockSize : Settings->BenchmarkCompressionBlockSizes)
+		{
+			FModCompressionProfile Profile;
+			Profile.CompressionFormat = CompressionFormat;
+			Profile.CompressionBlockSize = CompressionBlockSize;
+			Profile.PakAlignment = CurrentProfile.PakAlignment;
+
+			OutResults.Add(Measure(Profile, Files));
+		}
+	}
+
+	return true;
+}
+
+void FModCompressionBenchmark::WriteReport(const FString& ModName, const TArray<FModCompressionBenchmarkResult>& Results)
+{
+	TArray<TSharedPtr<FJsonValue>> ResultValues;
+
+	for (const FModCompressionBenchmarkResult& Result : Results)
+	{
+		UE_LOG(LogModSupportEditor, Display, TEXT("%s: %-8s %7d KB blocks: %10lld -> %10lld bytes (%5.1f%%), decompression %8.1f MB/s"),
+			*ModName, *Result.Profile.CompressionFormat.ToString(), Result.Profile.CompressionBlockSize / 1024,
+			Result.UncompressedSize, Result.CompressedSize, 100.0 * Result.CompressedSize / FMath::Max<int64>(Result.UncompressedSize, 1),
+			Result.GetDecompressionThroughput());
+
+		TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+		ResultObject->SetStringField(TEXT("compressionFormat"), Result.Profile.CompressionFormat.ToString());
+		ResultObject->SetNumberField(TEXT("compressionBlockSize"), Result.Profile.CompressionBlockSize);
+		ResultObject->SetNumberField(TEXT("pakAlignment"), Result.Profile.PakAlignment);
+		ResultObject->SetNumberField(TEXT("uncompressedSize"), Result.UncompressedSize);
+		ResultObject->SetNumberField(TEXT("compressedSize"), Result.CompressedSize);
+		ResultObject->SetNumberField(TEXT("compressSeconds"), Result.CompressSeconds);
+		ResultObject->SetNumberField(TEXT("decompressSeconds"), Result.DecompressSeconds);
+		ResultObject->SetNumberField(TEXT("decompressionMBPerSecond"), Result.GetDecompressionThroughput());
+		ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetStringField(TEXT("mod"), ModName);
+	RootObject->SetArrayField(TEXT("results"), ResultValues);
+
+	const FString ReportFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TEXT("CompressionBenchmark.json");
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *ReportFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to write %s"), *ReportFilename);
+	}
+}
+
+void FModCompressionBenchmark::GatherSample(TSharedRef<IPlugin> Plugin, const FString& TargetPlatform, int64 MaxSampleSize, TArray<TArray<uint8>>& OutFiles)
+{
+	FString SampleDir = FModPackager::GetCookedContentDir(Plugin, TargetPlatform);
+	if (!IFileManager::Get().DirectoryExists(*SampleDir))
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("%s has no cooked content for %s, sampling its editor packages instead"), *Plugin->GetName(), *TargetPlatform);
+		SampleDir = Plugin->GetContentDir();
+	}
+
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFilesRecursive(Filenames, *SampleDir, TEXT("*.*"), true, false);
+
+	// The files are found directory by directory, so taking the first ones would only sample a few kinds of assets
+	Filenames.Sort();
+	FRandomStream RandomStream(Filenames.Num());
+	for (int32 Index = Filenames.Num() - 1; Index > 0; --Index)
+	{
+		Filenames.Swap(Index, RandomStream.RandRange(0, Index));
+	}
+
+	int64 SampleSize = 0;
+	for (const FString& Filename : Filenames)
+	{
+		if (SampleSize >= MaxSampleSize)
+		{
+			break;
+		}
+
+		TArray<uint8>& File = OutFiles.AddDefaulted_GetRef();
+		if (!FFileHelper::LoadFileToArray(File, *Filename))
+		{
+			OutFiles.Pop(false);
+			continue;
+		}
+
+		SampleSize += File.Num();
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Sampled %d of %d file(s) of %s, %lld bytes"), OutFiles.Num(), Filenames.Num(), *Plugin->GetName(), SampleSize);
+}
+
+FModCompressionBenchmarkResult FModCompressionBenchmark::Measure(const FModCompressionProfile& Profile, const TArray<TArray<uint8>>& Files)
+{
+	FModCompressionBenchmarkResult Result;
+	Result.Profile = Profile;
+
+	const int32 BlockSize = Profile.CompressionBlockSize;
+	const FName Format = Profile.CompressionFormat;
+
+	TArray<uint8> CompressedBlock;
+	CompressedBlock.SetNumUninitialized(FCompression::CompressMemoryBound(Format, BlockSize));
+
+	TArray<uint8> UncompressedBlock;
+	UncompressedBlock.SetNumUninitialized(BlockSize);
+
+	for (const TArray<uint8>& File : Files)
+	{
+		int64 CompressedFileSize = 0;
+
+		for (int32 Offset = 0; Offset < File.Num(); Offset += BlockSize)
+		{
+			const int32 UncompressedBlockSize = FMath::Min(BlockSize, File.Num() - Offset);
+			int32 CompressedBlockSize = CompressedBlock.Num();
+
+			double StartTime = FPlatformTime::Seconds();
+			const bool bCompressed = FCompression::CompressMemory(Format, CompressedBlock.GetData(), CompressedBlockSize, File.GetData() + Offset, UncompressedBlockSize);
+			Result.CompressSeconds += FPlatformTime::Seconds() - StartTime;
+
+			// Like UnrealPak, blocks that don't get smaller are stored uncompressed and only copied when read
+			if (!bCompressed || CompressedBlockSize >= UncompressedBlockSize)
+			{
+				CompressedFileSize += UncompressedBlockSize;
+
+				StartTime = FPlatformTime::Seconds();
+				FMemory::Memcpy(UncompressedBlock.GetData(), File.GetData() + Offset, UncompressedBlockSize);
+				Result.DecompressSeconds += FPlatformTime::Seconds() - StartTime;
+				continue;
+			}
+
+			CompressedFileSize += CompressedBlockSize;
+
+			StartTime = FPlatformTime::Seconds();
+			FCompression::UncompressMemory(Format, UncompressedBlock.GetData(), UncompressedBlockSize, CompressedBlock.GetData(), CompressedBlockSize);
+			Result.DecompressSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		// The next file starts at the alignment, see FModPackager::GetCompressionOptions
+		if (Profile.PakAlignment > 0)
+		{
+			CompressedFileSize = Align(CompressedFileSize, (int64)Profile.PakAlignment);
+		}
+
+		Result.UncompressedSize += File.Num();
+		Result.CompressedSize += CompressedFileSize;
+	}
+
+	return Result;
+}
@@ -0,0 +1,164 @@
+#include "ModConflictChecker.h"
+
+#include "ModDependencyResolver.h"
+#include "ModPackageIndex.h"
+#include "ModPakManifest.h"
+#include "ModSupportEditorLog.h"
+#include "ModSupportSettings.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+
+int32 FModConflictChecker::Run(const TArray<TSharedRef<IPlugin>>& Mods, const FString& OutputDirectory, const FString& TargetPlatform)
+{
+	FModDependencyResolver Resolver;
+	for (TSharedRef<IPlugin> Plugin : Mods)
+	{
+		TArray<FString> PluginsRequire;
+		for (const FPluginReferenceDescriptor& Reference : Plugin->GetDescriptor().Plugins)
+		{
+			if (Reference.bEnabled)
+			{
+				PluginsRequire.Add(Reference.Name);
+			}
+		}
+
+		Resolver.AddMod(Plugin->GetName(), PluginsRequire);
+	}
+
+	// Requirements that aren't mods are checked by the packager, only the order of the mods matters here
+	Resolver.Resolve([](const FString& PluginName) { return true; });
+
+	for (const TPair<FString, FString>& Pair : Resolver.GetUnloadableMods())
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("%s isn't checked for conflicts, it can't be loaded: %s"), *Pair.Key, *Pair.Value);
+	}
+
+	FModPackageIndex PackageIndex;
+
+	// Every mod is mounted with the same read order, so the runtime resolves conflicts by mount order, which follows the waves
+	const int32 PakReadOrder = GetDefault<UModSupportSettings>()->PakReadOrder;
+
+	int32 NumMods = 0;
+	for (const TArray<FString>& Wave : Resolver.GetWaves())
+	{
+		for (const FString& ModName : Wave)
+		{
+			TArray<FString> PakFiles;
+			GetReleasePakFiles(ModName, OutputDirectory, TargetPlatform, PakFiles);
+
+			TArray<FName> Filenames;
+			GetPackageFilenames(ModName, PakFiles, Filenames);
+
+			PackageIndex.AddMod(ModName, PakReadOrder, MoveTemp(Filenames));
+			++NumMods;
+		}
+	}
+
+	TArray<FModPackageConflict> Conflicts;
+	PackageIndex.GetConflicts(Conflicts);
+
+	TArray<TSharedPtr<FJsonValue>> ConflictValues;
+	for (const FModPackageConflict& Conflict : Conflicts)
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("%s is shipped by several mods, %s overrides %s"),
+			*Conflict.Filename.ToString(), *Conflict.Winner, *FString::Join(Conflict.Overridden, TEXT(", ")));
+
+		TArray<TSharedPtr<FJsonValue>> OverriddenValues;
+		for (const FString& ModName : Conflict.Overridden)
+		{
+			OverriddenValues.Add(MakeShared<FJsonValueString>(ModName));
+		}
+
+		TSharedRef<FJsonObject> ConflictObject = MakeShared<FJsonObject>();
+		ConflictObject->SetStringField(TEXT("filename"), Conflict.Filename.ToString());
+		ConflictObject->SetStringField(TEXT("winner"), Conflict.Winner);
+		ConflictObject->SetArrayField(TEXT("overridden"), OverriddenValues);
+		ConflictValues.Add(MakeShared<FJsonValueObject>(ConflictObject));
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetArrayField(TEXT("conflicts"), ConflictValues);
+
+	const FString ReportFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModConflicts.json");
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *ReportFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to write %s"), *ReportFilename);
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("%d package file(s) are shipped by more than one of %d mod(s) for %s"), Conflicts.Num(), NumMods, *TargetPlatform);
+	return Conflicts.Num();
+}
+
+void FModConflictChecker::GetReleasePakFiles(const FString& ModName, const FString& OutputDirectory, const FString& TargetPlatform, TArray<FString>& OutPakFiles)
+{
+	// The manifest of the last release lists its full paks and every patch on top of them, see FModPackager::WritePakManifest
+	FModPakManifest PakManifest;
+	if (!PakManifest.Load(FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TargetPlatform / FModPakManifest::GetFilename()))
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("%s wasn't released for %s, it isn't checked for conflicts"), *ModName, *TargetPlatform);
+		return;
+	}
+
+	// Paks are written to <OutputDirectory>/<ModName>/<VersionId>/<TargetPlatform>
+	TArray<FString> PakFiles;
+	IFileManager::Get().FindFilesRecursive(PakFiles, *(OutputDirectory / ModName), TEXT("*.pak"), true, false);
+
+	for (const FString& PakFile : PakFiles)
+	{
+		if (FPaths::GetCleanFilename(FPaths::GetPath(PakFile)) == TargetPlatform && PakManifest.Paks.Contains(FPaths::GetCleanFilename(PakFile)))
+		{
+			OutPakFiles.Add(PakFile);
+		}
+	}
+
+	OutPakFiles.Sort();
+
+	if (OutPakFiles.Num() < PakManifest.Paks.Num())
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("Only %d of the %d pak(s) of the last release of %s for %s are in %s"),
+			OutPakFiles.Num(), PakManifest.Paks.Num(), *ModName, *TargetPlatform, *(OutputDirectory / ModName));
+	}
+}
+
+void FModConflictChecker::GetPackageFilenames(const FString& ModName, const TArray<FString>& PakFiles, TArray<FName>& OutFilenames)
+{
+	// The first line identifies the paks the cache was built from
+	FString PakStamp;
+	for (const FString& PakFile : PakFiles)
+	{
+		const FFileStatData StatData = IFileManager::Get().GetStatData(*PakFile);
+		PakStamp += FString::Printf(TEXT("%s|%lld|%s;"), *FPaths::GetCleanFilename(PakFile), StatData.FileSize, *StatData.ModificationTime.ToString());
+	}
+
+	const FString CacheFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TEXT("PackageIndex.txt");
+
+	TArray<FString> CacheLines;
+	if (FFileHelper::LoadFileToStringArray(CacheLines, *CacheFilename) && CacheLines.Num() > 0 && CacheLines[0] == PakStamp)
+	{
+		for (int32 Index = 1; Index < CacheLines.Num(); ++Index)
+		{
+			OutFilenames.Add(FName(*CacheLines[Index]));
+		}
+		return;
+	}
+
+	for (const FString& PakFile : PakFiles)
+	{
+		FModPackageIndex::ReadPakPackageFilenames(PakFile, OutFilenames);
+	}
+
+	CacheLines.Reset(OutFilenames.Num() + 1);
+	CacheLines.Add(PakStamp);
+	for (const FName& Filename : OutFilenames)
+	{
+		CacheLines.Add(Filename.ToString());
+	}
+
+	FFileHelper::SaveStringArrayToFile(CacheLines, *CacheFilename);
+}
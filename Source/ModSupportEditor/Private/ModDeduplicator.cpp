@@ -0,0 +1,257 @@
+#include "ModDeduplicator.h"
+
+#include "ModManager.h"
+#include "ModPackager.h"
+#include "ModSharedContentMap.h"
+#include "ModSupportEditorLog.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/SecureHash.h"
+#include "PluginDescriptor.h"
+
+namespace ModDeduplicator
+{
+	/** Extensions of the files a cooked package is split into */
+	static const TCHAR* PackageExtensions[] = { TEXT(".uasset"), TEXT(".uexp"), TEXT(".ubulk"), TEXT(".uptnl") };
+
+	/** A cooked package of a mod */
+	struct FCookedPackage
+	{
+		FString ModName;
+		FString PackageName;
+
+		/** Cooked filename without extension */
+		FString BaseFilename;
+
+		/** Hash over all files of the package, empty if it couldn't be read */
+		FString Hash;
+
+		/** Size of all files of the package */
+		int64 Size = 0;
+	};
+
+	static FString HashPackage(const FString& BaseFilename, int64& OutSize)
+	{
+		OutSize = 0;
+
+		FString FileHashes;
+		for (const TCHAR* Extension : PackageExtensions)
+		{
+			const FString Filename = BaseFilename + Extension;
+			const int64 FileSize = IFileManager::Get().FileSize(*Filename);
+			if (FileSize >= 0)
+			{
+				FileHashes += Extension;
+				FileHashes += LexToString(FMD5Hash::HashFile(*Filename));
+				OutSize += FileSize;
+			}
+		}
+		return FMD5::HashAnsiString(*FileHashes);
+	}
+
+	/** @return The mods a mod requires directly or through one of its requirements, without the mod itself */
+	static TSet<FString> GetAllRequirements(const FString& ModName, const TMap<FString, TArray<FString>>& ModRequirements)
+	{
+		TSet<FString> AllRequirements;
+		TArray<FString> PendingMods;
+		if (const TArray<FString>* Requirements = ModRequirements.Find(ModName))
+		{
+			PendingMods = *Requirements;
+		}
+
+		while (PendingMods.Num() > 0)
+		{
+			const FString RequiredMod = PendingMods.Pop(false);
+
+			bool bAlreadyFound = false;
+			AllRequirements.Add(RequiredMod, &bAlreadyFound);
+
+			if (!bAlreadyFound && RequiredMod != ModName)
+			{
+				if (const TArray<FString>* Requirements = ModRequirements.Find(RequiredMod))
+				{
+					PendingMods.Append(*Requirements);
+				}
+			}
+		}
+
+		AllRequirements.Remove(ModName);
+		return AllRequirements;
+	}
+}
+
+bool FModDeduplicator::Run(const TArray<TSharedRef<IPlugin>>& Mods, TArray<FString>& OutChangedMods)
+{
+	using namespace ModDeduplicator;
+
+	OutChangedMods.Reset();
+
+	const FString TargetPlatform = FModPackager::GetHostTargetPlatform();
+
+	TMap<FString, TArray<FString>> ModRequirements;
+	for (TSharedRef<IPlugin> Plugin : Mods)
+	{
+		TArray<FString>& Requirements = ModRequirements.Add(Plugin->GetName());
+		for (const FPluginReferenceDescriptor& Reference : Plugin->GetDescriptor().Plugins)
+		{
+			if (Reference.bEnabled)
+			{
+				Requirements.Add(Reference.Name);
+			}
+		}
+	}
+
+	TMap<FString, TSet<FString>> AllModRequirements;
+	for (const TPair<FString, TArray<FString>>& Pair : ModRequirements)
+	{
+		AllModRequirements.Add(Pair.Key, GetAllRequirements(Pair.Key, ModRequirements));
+	}
+
+	TArray<FCookedPackage> Packages;
+	for (TSharedRef<IPlugin> Plugin : Mods)
+	{
+		const FString CookedContentDir = FModPackager::GetCookedContentDir(Plugin, TargetPlatform);
+
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFilesRecursive(Filenames, *CookedContentDir, TEXT("*.uasset"), true, false);
+
+		if (Filenames.Num() == 0)
+		{
+			UE_LOG(LogModSupportEditor, Warning, TEXT("%s has no cooked content for %s, package it before deduplicating it"), *Plugin->GetName(), *TargetPlatform);
+			continue;
+		}
+
+		for (const FString& Filename : Filenames)
+		{
+			FString RelativePath = FPaths::ChangeExtension(Filename, FString());
+			FPaths::MakePathRelativeTo(RelativePath, *(CookedContentDir / TEXT("")));
+
+			FCookedPackage& Package = Packages.AddDefaulted_GetRef();
+			Package.ModName = Plugin->GetName();
+			Package.PackageName = Plugin->GetMountedAssetPath() / RelativePath;
+			Package.BaseFilename = FPaths::ChangeExtension(Filename, FString());
+		}
+	}
+
+	// Hashing reads all cooked content of every mod, which dominates the run
+	ParallelFor(Packages.Num(), [&Packages](int32 Index)
+	{
+		Packages[Index].Hash = HashPackage(Packages[Index].BaseFilename, Packages[Index].Size);
+	});
+
+	TMap<FString, TArray<int32>> PackagesByHash;
+	for (int32 Index = 0; Index < Packages.Num(); ++Index)
+	{
+		PackagesByHash.FindOrAdd(Packages[Index].Hash).Add(Index);
+	}
+
+	FModSharedContentMap SharedContentMap;
+	int64 SavedSize = 0;
+
+	for (TPair<FString, TArray<int32>>& Pair : PackagesByHash)
+	{
+		if (Pair.Value.Num() < 2)
+		{
+			continue;
+		}
+
+		// Mods with fewer requirements come first, so a package is redirected to the copy furthest down the requirements
+		Pair.Value.Sort([&Packages, &AllModRequirements](int32 A, int32 B)
+		{
+			const int32 NumRequirementsA = AllModRequirements.FindChecked(Packages[A].ModName).Num();
+			const int32 NumRequirementsB = AllModRequirements.FindChecked(Packages[B].ModName).Num();
+			return NumRequirementsA != NumRequirementsB ? NumRequirementsA < NumRequirementsB : Packages[A].PackageName < Packages[B].PackageName;
+		});
+
+		// Only copies in a mod that is mounted before the duplicate can replace it, any other copy stays where it is
+		TArray<int32> KeptPackages;
+		for (int32 Index : Pair.Value)
+		{
+			const FCookedPackage& Package = Packages[Index];
+			const TSet<FString>& Requirements = AllModRequirements.FindChecked(Package.ModName);
+
+			const int32* KeptIndex = KeptPackages.FindByPredicate([&Packages, &Requirements](int32 Kept)
+			{
+				return Requirements.Contains(Packages[Kept].ModName);
+			});
+
+			if (KeptIndex != nullptr)
+			{
+				SharedContentMap.Redirects.Add(Package.PackageName, Packages[*KeptIndex].PackageName);
+				SavedSize += Package.Size;
+			}
+			else
+			{
+				KeptPackages.Add(Index);
+			}
+		}
+	}
+	FModSharedContentMap PreviousMap;
+	PreviousMap.Load(GetSharedContentMapFilename());
+
+	TSet<FString> ChangedMods;
+	for (const TPair<FString, FString>& Pair : SharedContentMap.Redirects)
+	{
+		const FString* PreviousRedirect = PreviousMap.Redirects.Find(Pair.Key);
+		if (PreviousRedirect == nullptr || *PreviousRedirect != Pair.Value)
+		{
+			FString Root;
+			FModManager::GetMountPointRoot(Pair.Key, Root);
+			ChangedMods.Add(Root);
+		}
+	}
+	for (const TPair<FString, FString>& Pair : PreviousMap.Redirects)
+	{
+		if (!SharedContentMap.Redirects.Contains(Pair.Key))
+		{
+			FString Root;
+			FModManager::GetMountPointRoot(Pair.Key, Root);
+			ChangedMods.Add(Root);
+		}
+	}
+	OutChangedMods = ChangedMods.Array();
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Found %d package(s) duplicating a required mod in %d mod(s), saving %lld KB"),
+		SharedContentMap.Redirects.Num(), Mods.Num(), SavedSize / 1024);
+
+	return SharedContentMap.Save(GetSharedContentMapFilename());
+}
+
+void FModDeduplicator::GetSharedContentMap(const FString& ModName, FModSharedContentMap& OutMap)
+{
+	OutMap.Redirects.Reset();
+
+	FModSharedContentMap SharedContentMap;
+	if (!SharedContentMap.Load(GetSharedContentMapFilename()))
+	{
+		return;
+	}
+
+	for (const TPair<FString, FString>& Pair : SharedContentMap.Redirects)
+	{
+		FString Root;
+		if (FModManager::GetMountPointRoot(Pair.Key, Root) && Root == ModName)
+		{
+			OutMap.Redirects.Add(Pair.Key, Pair.Value);
+		}
+	}
+}
+
+void FModDeduplicator::GetSharedPackages(const FString& ModName, TArray<FName>& OutPackages)
+{
+	OutPackages.Reset();
+
+	FModSharedContentMap SharedContentMap;
+	GetSharedContentMap(ModName, SharedContentMap);
+
+	for (const TPair<FString, FString>& Pair : SharedContentMap.Redirects)
+	{
+		OutPackages.Add(FName(*Pair.Key));
+	}
+}
+
+FString FModDeduplicator::GetSharedContentMapFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / FModSharedContentMap::GetFilename();
+}
@@ -0,0 +1,96 @@
+#include "ModFarmGenerator.h"
+#include "ModManager.h"
+#include "ModSharedContentMap.h"
+#include "ModSupportSettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeExit.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FModDeduplicatorLoadTest, "ModSupport.Deduplicator.LoadRedirectedPackage", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * Mounts a base mod and a mod whose copy of a package was deduplicated against it, the way the packager ships them:
+ * the copy is missing from the mod and only listed in the shared content map next to its paks.
+ *
+ * The benchmarks only measure, so they run as commandlets. Whether a deduplicated package still loads has a single
+ * right answer, and is only seen once the mods are mounted, so it is checked here.
+ */
+bool FModDeduplicatorLoadTest::RunTest(const FString& Parameters)
+{
+	FModFarmSettings FarmSettings;
+	FarmSettings.NamePrefix = TEXT("ModDedupeTest");
+	FarmSettings.NumMods = 2;
+	FarmSettings.AssetsPerMod = 1;
+	// The deduplicated asset is removed from the mod below, which takes loose content
+	FarmSettings.bPakContent = false;
+
+	UModSupportSettings* Settings = GetMutableDefault<UModSupportSettings>();
+	const FString OriginalModsDirectory = Settings->ModsDirectory;
+	const bool bOriginalMountOnDemand = Settings->bMountOnDemand;
+
+	Settings->ModsDirectory = TEXT("Saved/ModInfo/ModFarm") / FarmSettings.NamePrefix;
+	Settings->bMountOnDemand = false;
+	FarmSettings.OutputDir = FPaths::ProjectDir() / Settings->ModsDirectory;
+
+	TSharedPtr<FModManager> ModManager;
+
+	// Nothing the test mounted or generated outlives it, whichever way it ends
+	ON_SCOPE_EXIT
+	{
+		if (ModManager.IsValid())
+		{
+			ModManager->UnmountMods();
+			ModManager.Reset();
+		}
+
+		Settings->ModsDirectory = OriginalModsDirectory;
+		Settings->bMountOnDemand = bOriginalMountOnDemand;
+
+		IFileManager::Get().DeleteDirectory(*FarmSettings.OutputDir, false, true);
+		IFileManager::Get().DeleteDirectory(*FModFarmGenerator::GetTemplateDir(FarmSettings), false, true);
+	};
+
+	if (!FModFarmGenerator::Generate(FarmSettings))
+	{
+		AddError(TEXT("Failed to generate the mods"));
+		return false;
+	}
+
+	// Both mods were generated from the same template, so their copies of the asset are byte-identical
+	const FString BaseModName = FModFarmGenerator::GetModName(FarmSettings, 0);
+	const FString ModName = FModFarmGenerator::GetModName(FarmSettings, 1);
+	const FString BasePackageName = FPackageName::ObjectPathToPackageName(FModFarmGenerator::GetAssetPath(FarmSettings, 0, 0));
+	const FString PackageName = FPackageName::ObjectPathToPackageName(FModFarmGenerator::GetAssetPath(FarmSettings, 1, 0));
+
+	const FString ModDir = FarmSettings.OutputDir / ModName;
+	IFileManager::Get().Delete(*(ModDir / TEXT("Content") / FPackageName::GetShortName(PackageName) + FPackageName::GetAssetPackageExtension()), false, true, true);
+
+	FModSharedContentMap SharedContentMap;
+	SharedContentMap.Redirects.Add(PackageName, BasePackageName);
+	TestTrue(TEXT("Saved the shared content map"), SharedContentMap.Save(ModDir / TEXT("Content") / TEXT("Paks") / FPlatformProperties::PlatformName() / FModSharedContentMap::GetFilename()));
+
+	ModManager = MakeShared<FModManager>();
+	ModManager->SetManifestCacheFilename(FarmSettings.OutputDir / TEXT("ModManifestCache.bin"));
+	ModManager->DiscoverMods();
+	ModManager->MountModsAsync();
+	ModManager->WaitForPendingMounts();
+
+	const FModRecord* BaseMod = ModManager->FindMod(BaseModName);
+	const FModRecord* Mod = ModManager->FindMod(ModName);
+	TestTrue(TEXT("Mounted the base mod"), BaseMod != nullptr && BaseMod->State == EModState::Mounted);
+	TestTrue(TEXT("Mounted the deduplicated mod"), Mod != nullptr && Mod->State == EModState::Mounted);
+
+	UObject* Asset = LoadObject<UObject>(nullptr, *FModFarmGenerator::GetAssetPath(FarmSettings, 1, 0));
+	if (TestNotNull(TEXT("Loaded the deduplicated asset"), Asset))
+	{
+		TestEqual(TEXT("Loaded the deduplicated asset from the base mod"), Asset->GetOutermost()->GetName(), BasePackageName);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "ModDirtyPackageTracker.h"
+
+#include "ModManager.h"
+#include "FileHelpers.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+
+FModDirtyPackageTracker::FModDirtyPackageTracker()
+{
+	PackageDirtyStateChangedHandle = UPackage::PackageDirtyStateChangedEvent.AddRaw(this, &FModDirtyPackageTracker::HandlePackageDirtyStateChanged);
+	PackageSavedHandle = UPackage::PackageSavedEvent.AddRaw(this, &FModDirtyPackageTracker::HandlePackageSaved);
+
+	// Packages dirtied before the tracker existed didn't send any event we could have seen
+	TArray<UPackage*> UnsavedPackages;
+	FEditorFileUtils::GetDirtyContentPackages(UnsavedPackages);
+	FEditorFileUtils::GetDirtyWorldPackages(UnsavedPackages);
+
+	for (UPackage* Package : UnsavedPackages)
+	{
+		UpdatePackage(Package);
+	}
+}
+
+FModDirtyPackageTracker::~FModDirtyPackageTracker()
+{
+	UPackage::PackageDirtyStateChangedEvent.Remove(PackageDirtyStateChangedHandle);
+	UPackage::PackageSavedEvent.Remove(PackageSavedHandle);
+}
+
+bool FModDirtyPackageTracker::HasDirtyPackages(const FString& MountedAssetPath)
+{
+	FString Root;
+	if (!FModManager::GetMountPointRoot(MountedAssetPath, Root))
+	{
+		return false;
+	}
+
+	TSet<FName>* MountPointPackages = DirtyPackages.Find(FName(*Root));
+	if (MountPointPackages == nullptr)
+	{
+		return false;
+	}
+
+	// A dirty package that was deleted or garbage collected never reports that it is clean
+	for (auto It = MountPointPackages->CreateIterator(); It; ++It)
+	{
+		UPackage* Package = FindObjectFast<UPackage>(nullptr, *It);
+		if (Package == nullptr || !Package->IsDirty())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	return MountPointPackages->Num() > 0;
+}
+
+void FModDirtyPackageTracker::HandlePackageDirtyStateChanged(UPackage* Package)
+{
+	UpdatePackage(Package);
+}
+
+void FModDirtyPackageTracker::HandlePackageSaved(const FString& PackageFilename, UObject* Outer)
+{
+	if (UPackage* Package = Cast<UPackage>(Outer))
+	{
+		UpdatePackage(Package);
+	}
+}
+
+void FModDirtyPackageTracker::UpdatePackage(UPackage* Package)
+{
+	if (Package == nullptr || Package == GetTransientPackage())
+	{
+		return;
+	}
+
+	FString Root;
+	if (!FModManager::GetMountPointRoot(Package->GetName(), Root))
+	{
+		return;
+	}
+
+	if (Package->IsDirty())
+	{
+		DirtyPackages.FindOrAdd(FName(*Root)).Add(Package->GetFName());
+	}
+	else if (TSet<FName>* MountPointPackages = DirtyPackages.Find(FName(*Root)))
+	{
+		MountPointPackages->Remove(Package->GetFName());
+	}
+}
@@ -0,0 +1,191 @@
+#include "ModFarmGenerator.h"
+
+#include "ModPakManifest.h"
+#include "ModSupportEditorLog.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "PakFileUtilities.h"
+#include "PluginDescriptor.h"
+#include "UObject/Package.h"
+
+bool FModFarmGenerator::Generate(const FModFarmSettings& Settings)
+{
+	const FString TemplateDir = IPluginManager::Get().FindPlugin(TEXT("ModSupport"))->GetBaseDir() / TEXT("Templates") / TEXT("BaseTemplate");
+	const FString TemplateContentDir = GetTemplateDir(Settings) / TEXT("Content/");
+
+	if (!CreateTemplateAssets(Settings, TemplateContentDir))
+	{
+		return false;
+	}
+
+	IFileManager& FileManager = IFileManager::Get();
+
+	for (int32 ModIndex = 0; ModIndex < Settings.NumMods; ++ModIndex)
+	{
+		const FString ModName = GetModName(Settings, ModIndex);
+		const FString ModDir = Settings.OutputDir / ModName;
+		const FString DescriptorFilename = ModDir / ModName + TEXT(".uplugin");
+		const FString PakFilename = ModDir / TEXT("Content") / TEXT("Paks") / FPlatformProperties::PlatformName() / ModName + TEXT(".pak");
+
+		// Mods generated with loose content are regenerated when a pak is asked for
+		if (FileManager.FileExists(*DescriptorFilename) && (!Settings.bPakContent || FileManager.FileExists(*PakFilename)))
+		{
+			continue;
+		}
+
+		// The template provides everything but the descriptor, which is what the plugin wizard generates as well
+		if (!FileManager.IterateDirectoryRecursively(*TemplateDir, [&](const TCHAR* Path, bool bIsDirectory)
+		{
+			FString RelativePath = Path;
+			FPaths::MakePathRelativeTo(RelativePath, *(TemplateDir + TEXT("/")));
+			return bIsDirectory || FileManager.Copy(*(ModDir / RelativePath), Path) == COPY_OK;
+		}))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to copy the template to %s"), *ModDir);
+			return false;
+		}
+
+		for (int32 AssetIndex = 0; AssetIndex < Settings.AssetsPerMod; ++AssetIndex)
+		{
+			const FString AssetFilename = FString::Printf(TEXT("Asset_%d"), AssetIndex) + FPackageName::GetAssetPackageExtension();
+			if (FileManager.Copy(*(ModDir / TEXT("Content") / AssetFilename), *(TemplateContentDir / AssetFilename)) != COPY_OK)
+			{
+				UE_LOG(LogModSupportEditor, Error, TEXT("Failed to copy %s to %s"), *AssetFilename, *ModDir);
+				return false;
+			}
+		}
+
+		if (Settings.bPakContent && !PakModContent(Settings, ModDir, PakFilename))
+		{
+			return false;
+		}
+
+		FPluginDescriptor Descriptor;
+		Descriptor.Version = 1;
+		Descriptor.VersionName = TEXT("1.0");
+		Descriptor.FriendlyName = ModName;
+		Descriptor.Description = TEXT("Synthetic mod generated by FModFarmGenerator");
+		Descriptor.Category = TEXT("ModFarm");
+		Descriptor.CreatedBy = TEXT("ModFarm");
+		Descriptor.bCanContainContent = true;
+
+		FText FailReason;
+		if (!Descriptor.Save(DescriptorFilename, FailReason))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save %s: %s"), *DescriptorFilename, *FailReason.ToString());
+			return false;
+		}
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Generated mod farm of %d mod(s) in %s"), Settings.NumMods, *Settings.OutputDir);
+	return true;
+}
+
+FString FModFarmGenerator::GetModName(const FModFarmSettings& Settings, int32 ModIndex)
+{
+	return FString::Printf(TEXT("%s_%05d"), *Settings.NamePrefix, ModIndex);
+}
+
+FString FModFarmGenerator::GetAssetPath(const FModFarmSettings& Settings, int32 ModIndex, int32 AssetIndex)
+{
+	return FString::Printf(TEXT("/%s/Asset_%d.Asset_%d"), *GetModName(Settings, ModIndex), AssetIndex, AssetIndex);
+}
+
+FString FModFarmGenerator::GetTemplateDir(const FModFarmSettings& Settings)
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModFarmTemplate") / Settings.NamePrefix;
+}
+
+bool FModFarmGenerator::PakModContent(const FModFarmSettings& Settings, const FString& ModDir, const FString& PakFilename)
+{
+	const FString RootDir = FPaths::ConvertRelativePathToFull(FPaths::RootDir());
+	const FString ContentDir = FPaths::ConvertRelativePathToFull(ModDir / TEXT("Content"));
+
+	// Like staged files, the pak entries are relative to the root directory, so the pak mounts over the content directory of the mod
+	TArray<FString> AssetFilenames;
+	TArray<FString> ResponseLines;
+	for (int32 AssetIndex = 0; AssetIndex < Settings.AssetsPerMod; ++AssetIndex)
+	{
+		const FString AssetFilename = ContentDir / FString::Printf(TEXT("Asset_%d"), AssetIndex) + FPackageName::GetAssetPackageExtension();
+
+		FString StagedFilename = AssetFilename;
+		FPaths::MakePathRelativeTo(StagedFilename, *RootDir);
+
+		AssetFilenames.Add(AssetFilename);
+		ResponseLines.Add(FString::Printf(TEXT("\"%s\" \"../../../%s\""), *AssetFilename, *StagedFilename));
+	}
+
+	const FString ResponseFilename = FPaths::ConvertRelativePathToFull(GetTemplateDir(Settings) / TEXT("PakList.txt"));
+	if (!FFileHelper::SaveStringArrayToFile(ResponseLines, *ResponseFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to write %s"), *ResponseFilename);
+		return false;
+	}
+
+	const FString FullPakFilename = FPaths::ConvertRelativePathToFull(PakFilename);
+	if (!ExecuteUnrealPak(*FString::Printf(TEXT("\"%s\" -create=\"%s\""), *FullPakFilename, *ResponseFilename)))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to create %s"), *FullPakFilename);
+		return false;
+	}
+
+	// The manifest lets the farm mods go through pak verification like packaged mods
+	FModPakManifest PakManifest;
+	const FString PakManifestFilename = FPaths::GetPath(FullPakFilename) / FModPakManifest::GetFilename();
+	if (!PakManifest.Build({ FullPakFilename }) || !PakManifest.Save(PakManifestFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save %s"), *PakManifestFilename);
+		return false;
+	}
+
+	for (const FString& AssetFilename : AssetFilenames)
+	{
+		IFileManager::Get().Delete(*AssetFilename);
+	}
+
+	return true;
+}
+
+bool FModFarmGenerator::CreateTemplateAssets(const FModFarmSettings& Settings, const FString& TemplateContentDir)
+{
+	const FString MountPoint = FString::Printf(TEXT("/%sTemplate/"), *Settings.NamePrefix);
+	FPackageName::RegisterMountPoint(MountPoint, TemplateContentDir);
+
+	// Random texels don't compress, so the size of the saved package follows the requested asset size
+	const int32 TextureSize = FMath::Max(FMath::RoundUpToPowerOfTwo(FMath::CeilToInt(FMath::Sqrt(Settings.AssetSize / 4.0f))), 1U);
+	FRandomStream RandomStream(Settings.AssetSize);
+
+	bool bSuccess = true;
+
+	for (int32 AssetIndex = 0; AssetIndex < Settings.AssetsPerMod && bSuccess; ++AssetIndex)
+	{
+		const FString AssetName = FString::Printf(TEXT("Asset_%d"), AssetIndex);
+		const FString PackageName = MountPoint + AssetName;
+		const FString PackageFilename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+
+		UPackage* Package = CreatePackage(nullptr, *PackageName);
+		UTexture2D* Texture = NewObject<UTexture2D>(Package, *AssetName, RF_Public | RF_Standalone);
+
+		Texture->Source.Init(TextureSize, TextureSize, 1, 1, TSF_BGRA8);
+		uint8* MipData = Texture->Source.LockMip(0);
+		for (int32 Index = 0; Index < TextureSize * TextureSize * 4; ++Index)
+		{
+			MipData[Index] = (uint8)RandomStream.RandHelper(256);
+		}
+		Texture->Source.UnlockMip(0);
+
+		bSuccess = UPackage::SavePackage(Package, Texture, RF_Public | RF_Standalone, *PackageFilename);
+		if (!bSuccess)
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save %s"), *PackageFilename);
+		}
+	}
+
+	FPackageName::UnRegisterMountPoint(MountPoint, TemplateContentDir);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return bSuccess;
+}
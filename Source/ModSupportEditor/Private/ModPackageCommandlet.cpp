@@ -0,0 +1,322 @@
+#include "ModPackageCommandlet.h"
+
+#include "ModCompressionBenchmark.h"
+#include "ModConflictChecker.h"
+#include "ModDeduplicator.h"
+#include "ModPackager.h"
+#include "ModReferenceValidator.h"
+#include "ModReleaseManifest.h"
+#include "AssetRegistryModule.h"
+#include "ModSupportEditorLog.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Parse.h"
+
+namespace ModPackageCommandlet
+{
+	/** A HotPatcher process packaging a single mod for a single platform */
+	struct FJob
+	{
+		FString ModName;
+		FString TargetPlatform;
+		FString ConfigFilename;
+		FModPackageOptions Options;
+		FProcHandle ProcessHandle;
+
+		/** UTC time the process was started, content cooked before it is left over from earlier runs */
+		FDateTime StartTime;
+
+		/** Manifest saved once the mod was packaged successfully for every platform, shared by the jobs of its platforms */
+		TSharedPtr<FModReleaseManifest> ReleaseManifest;
+	};
+}
+
+UModPackageCommandlet::UModPackageCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UModPackageCommandlet::Main(const FString& Params)
+{
+	using namespace ModPackageCommandlet;
+
+	const bool bBenchmarkCompression = FParse::Param(*Params, TEXT("BenchmarkCompression"));
+	const bool bValidateOnly = FParse::Param(*Params, TEXT("ValidateOnly"));
+
+	FString OutputDirectory;
+	if (!FParse::Value(*Params, TEXT("OutputDir="), OutputDirectory) && !bBenchmarkCompression && !bValidateOnly)
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Missing -OutputDir=<Directory>"));
+		return 1;
+	}
+	OutputDirectory = FPaths::ConvertRelativePathToFull(OutputDirectory);
+
+	TArray<FString> ModFilter;
+	FString ModFilterValue;
+	if (FParse::Value(*Params, TEXT("Mods="), ModFilterValue))
+	{
+		ModFilterValue.ParseIntoArray(ModFilter, TEXT("+"));
+	}
+
+	int32 MaxJobs = FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+	FParse::Value(*Params, TEXT("MaxJobs="), MaxJobs);
+	MaxJobs = FMath::Max(MaxJobs, 1);
+
+	const bool bFullPackage = FParse::Param(*Params, TEXT("Full"));
+
+	FModPackageOptions PlatformOptions;
+	FString PlatformsValue;
+	if (FParse::Value(*Params, TEXT("Platforms="), PlatformsValue))
+	{
+		PlatformsValue.ParseIntoArray(PlatformOptions.TargetPlatforms, TEXT("+"));
+	}
+
+	TArray<FString> TargetPlatforms;
+	FModPackager::GetTargetPlatforms(PlatformOptions, TargetPlatforms);
+
+	FString DeltaFromDirectory;
+	if (FParse::Value(*Params, TEXT("DeltaFrom="), DeltaFromDirectory))
+	{
+		DeltaFromDirectory = FPaths::ConvertRelativePathToFull(DeltaFromDirectory);
+	}
+
+	TArray<TSharedRef<IPlugin>> AvailableGameMods;
+	FModPackager::FindAvailableGameMods(AvailableGameMods);
+
+	// Duplicates are searched across every mod, the filter only selects which mods are packaged
+	TArray<FString> ModsWithChangedSharedPackages;
+	if (FParse::Param(*Params, TEXT("Deduplicate")) && !bBenchmarkCompression && !bValidateOnly)
+	{
+		if (!FModDeduplicator::Run(AvailableGameMods, ModsWithChangedSharedPackages))
+		{
+			return 1;
+		}
+	}
+
+	const TArray<TSharedRef<IPlugin>> AllGameMods = AvailableGameMods;
+
+	if (ModFilter.Num() > 0)
+	{
+		// A mod whose redirected packages changed is packaged even if filtered out, its released paks no longer match the map
+		AvailableGameMods.RemoveAll([&ModFilter, &ModsWithChangedSharedPackages](const TSharedRef<IPlugin>& Plugin)
+		{
+			if (ModFilter.Contains(Plugin->GetName()))
+			{
+				return false;
+			}
+			if (ModsWithChangedSharedPackages.Contains(Plugin->GetName()))
+			{
+				UE_LOG(LogModSupportEditor, Display, TEXT("%s: shared packages changed, packaging it although it isn't in -Mods"), *Plugin->GetName());
+				return false;
+			}
+			return true;
+		});
+	}
+
+	if (bBenchmarkCompression)
+	{
+		int32 NumFailedBenchmarks = 0;
+
+		for (TSharedRef<IPlugin> Plugin : AvailableGameMods)
+		{
+			TArray<FModCompressionBenchmarkResult> Results;
+			if (FModCompressionBenchmark::Run(Plugin, FModPackager::GetHostTargetPlatform(), Results))
+			{
+				FModCompressionBenchmark::WriteReport(Plugin->GetName(), Results);
+			}
+			else
+			{
+				++NumFailedBenchmarks;
+			}
+		}
+
+		return NumFailedBenchmarks > 0 ? 1 : 0;
+	}
+
+	// Validated before the whole asset registry is searched, the validator only scans the packages that changed since it last ran
+	TSet<FString> InvalidMods;
+	if (bValidateOnly || FParse::Param(*Params, TEXT("ValidateReferences")))
+	{
+		TArray<FModReferenceViolation> Violations;
+		FModReferenceValidator::Run(AvailableGameMods, Violations);
+
+		if (bValidateOnly)
+		{
+			return Violations.Num() > 0 ? 1 : 0;
+		}
+
+		for (const FModReferenceViolation& Violation : Violations)
+		{
+			InvalidMods.Add(Violation.ModName);
+		}
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	// Write every configuration up front, so a bad template fails before any job was started
+	TArray<FJob> PendingMods;
+	TMap<FString, int32> RemainingPlatforms;
+	TSet<FString> FailedMods;
+	int32 NumFailed = 0;
+	int32 NumUpToDate = 0;
+
+	for (TSharedRef<IPlugin> Plugin : AvailableGameMods)
+	{
+		if (InvalidMods.Contains(Plugin->GetName()))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("%s references content it can't rely on at runtime, it isn't packaged"), *Plugin->GetName());
+			++NumFailed;
+			continue;
+		}
+
+		FJob Job;
+		Job.ModName = Plugin->GetName();
+		Job.ReleaseManifest = MakeShared<FModReleaseManifest>();
+		Job.ReleaseManifest->Build(Plugin);
+
+		FModPackageOptions Options;
+		Options.TargetPlatforms = TargetPlatforms;
+
+		// A patch pak can't take packages out of the older paks, so a mod whose shared packages changed is packaged completely
+		const bool bSharedPackagesChanged = ModsWithChangedSharedPackages.Contains(Job.ModName);
+		if (bSharedPackagesChanged)
+		{
+			UE_LOG(LogModSupportEditor, Display, TEXT("%s: shared packages changed, packaging it completely"), *Job.ModName);
+		}
+
+		FModReleaseManifest PreviousManifest;
+		if (!bFullPackage && !bSharedPackagesChanged && PreviousManifest.Load(FModReleaseManifest::GetManifestFilename(Job.ModName)))
+		{
+			if (Job.ReleaseManifest->GetChangedPackages(PreviousManifest, Options.IncrementalPackages))
+			{
+				if (Options.IncrementalPackages.Num() == 0)
+				{
+					UE_LOG(LogModSupportEditor, Display, TEXT("%s is up to date"), *Job.ModName);
+					++NumUpToDate;
+					continue;
+				}
+
+				Options.PatchIndex = PreviousManifest.PatchCount + 1;
+				Job.ReleaseManifest->PatchCount = Options.PatchIndex;
+
+				UE_LOG(LogModSupportEditor, Display, TEXT("%s: %d changed package(s) go into patch %d"), *Job.ModName, Options.IncrementalPackages.Num(), Options.PatchIndex);
+			}
+			else
+			{
+				UE_LOG(LogModSupportEditor, Display, TEXT("%s: packages were removed since the last release, packaging it completely"), *Job.ModName);
+			}
+		}
+
+		// The dependency analysis, hashing and asset gathering of a mod are done once, only the cooks are per platform
+		TArray<FString> ConfigFilenames;
+		if (FModPackager::WritePackageConfig(Plugin, OutputDirectory / Job.ModName, Options, ConfigFilenames))
+		{
+			Job.Options = MoveTemp(Options);
+			RemainingPlatforms.Add(Job.ModName, TargetPlatforms.Num());
+
+			for (int32 Index = 0; Index < TargetPlatforms.Num(); ++Index)
+			{
+				FJob& PlatformJob = PendingMods.Add_GetRef(Job);
+				PlatformJob.TargetPlatform = TargetPlatforms[Index];
+				PlatformJob.ConfigFilename = ConfigFilenames[Index];
+			}
+		}
+		else
+		{
+			++NumFailed;
+		}
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Packaging %d mod(s) for %d platform(s) with up to %d concurrent job(s)"), RemainingPlatforms.Num(), TargetPlatforms.Num(), MaxJobs);
+
+	const FString ExecutablePath = FPlatformProcess::ExecutablePath();
+	TArray<FJob> RunningJobs;
+	int32 NextMod = 0;
+
+	while (NextMod < PendingMods.Num() || RunningJobs.Num() > 0)
+	{
+		while (NextMod < PendingMods.Num() && RunningJobs.Num() < MaxJobs)
+		{
+			FJob Job = PendingMods[NextMod++];
+			Job.StartTime = FDateTime::UtcNow();
+			Job.ProcessHandle = FPlatformProcess::CreateProc(*ExecutablePath, *FModPackager::GetPackageCommandLine(Job.ConfigFilename), false, true, true, nullptr, 0, nullptr, nullptr);
+
+			if (Job.ProcessHandle.IsValid())
+			{
+				UE_LOG(LogModSupportEditor, Display, TEXT("Started packaging %s for %s"), *Job.ModName, *Job.TargetPlatform);
+				RunningJobs.Add(Job);
+			}
+			else
+			{
+				UE_LOG(LogModSupportEditor, Error, TEXT("Failed to start packaging %s for %s"), *Job.ModName, *Job.TargetPlatform);
+				FailedMods.Add(Job.ModName);
+
+				if (--RemainingPlatforms[Job.ModName] == 0)
+				{
+					++NumFailed;
+				}
+			}
+		}
+
+		for (int32 Index = RunningJobs.Num() - 1; Index >= 0; --Index)
+		{
+			FJob& Job = RunningJobs[Index];
+			if (FPlatformProcess::IsProcRunning(Job.ProcessHandle))
+			{
+				continue;
+			}
+
+			int32 ReturnCode = -1;
+			FPlatformProcess::GetProcReturnCode(Job.ProcessHandle, &ReturnCode);
+			FPlatformProcess::CloseProc(Job.ProcessHandle);
+
+			if (ReturnCode == 0
+				&& FModPackager::VerifyCookedContent(Job.ModName, Job.TargetPlatform, Job.StartTime)
+				&& FModPackager::VerifyShaderLibrary(Job.ModName, Job.TargetPlatform)
+				&& FModPackager::WritePakManifest(Job.ModName, OutputDirectory / Job.ModName, Job.Options, Job.TargetPlatform))
+			{
+				if (!DeltaFromDirectory.IsEmpty() && !FModPackager::WritePakDeltas(Job.ModName, OutputDirectory / Job.ModName, DeltaFromDirectory / Job.ModName, Job.Options, Job.TargetPlatform))
+				{
+					UE_LOG(LogModSupportEditor, Warning, TEXT("Failed to write the pak deltas of %s for %s, players have to download its paks completely"), *Job.ModName, *Job.TargetPlatform);
+				}
+
+				UE_LOG(LogModSupportEditor, Display, TEXT("Packaged %s for %s"), *Job.ModName, *Job.TargetPlatform);
+			}
+			else
+			{
+				UE_LOG(LogModSupportEditor, Error, TEXT("Failed to package %s for %s, exit code %d"), *Job.ModName, *Job.TargetPlatform, ReturnCode);
+				FailedMods.Add(Job.ModName);
+			}
+
+			// The release only counts once every platform was packaged, otherwise the next run packages the mod again
+			if (--RemainingPlatforms[Job.ModName] == 0)
+			{
+				if (FailedMods.Contains(Job.ModName))
+				{
+					++NumFailed;
+				}
+				else
+				{
+					Job.ReleaseManifest->Save(FModReleaseManifest::GetManifestFilename(Job.ModName));
+				}
+			}
+
+			RunningJobs.RemoveAtSwap(Index);
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Packaged %d of %d mod(s), %d were up to date"), AvailableGameMods.Num() - NumFailed - NumUpToDate, AvailableGameMods.Num(), NumUpToDate);
+
+	// Conflicts are checked across every mod, a freshly packaged mod can conflict with any of the others
+	if (FParse::Param(*Params, TEXT("CheckConflicts")))
+	{
+		FModConflictChecker::Run(AllGameMods, OutputDirectory, TargetPlatforms[0]);
+	}
+
+	return NumFailed > 0 ? 1 : 0;
+}
@@ -1,6 +1,18 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ModPackager.h"
+#include "ModChunker.h"
+#include "ModChunkMap.h"
+#include "ModDeduplicator.h"
+#include "ModDirtyPackageTracker.h"
+#include "ModManager.h"
+#include "ModPakDelta.h"
+#include "ModPakManifest.h"
+#include "ModLoadOrderRecorder.h"
+#include "ModPackagingQueue.h"
+#include "ModPackagingSettings.h"
+#include "ModReferenceValidator.h"
+#include "ModSharedContentMap.h"
 #include "ModSupportEditor.h"
 #include "ModSupportEditorCommands.h"
 #include "ModSupportEditorStyle.h"
@@ -10,21 +22,83 @@
 #include "Widgets/SWidget.h"
 #include "Interfaces/IPluginManager.h"
 #include "Developer/DesktopPlatform/Public/DesktopPlatformModule.h"
-#include "Editor/UATHelper/Public/IUATHelperModule.h"
 #include "Editor/MainFrame/Public/Interfaces/IMainFrameModule.h"
+#include "AssetRegistryModule.h"
+#include "AssetRegistryState.h"
+#include "DirectoryWatcherModule.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+#include "IDirectoryWatcher.h"
 
 #include "FileHelpers.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
 #include "Misc/FileHelper.h"
 #include "Misc/PackageName.h"
+#include "Serialization/MemoryWriter.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
 
 #define LOCTEXT_NAMESPACE "ModPackager"
 
+namespace ModPackager
+{
+	/** @return A HotPatcher entry that packages exactly the given package */
+	static TSharedRef<FJsonValue> MakeSpecifyAsset(const FName& PackageName)
+	{
+		const FString PackageNameString = PackageName.ToString();
+
+		TSharedRef<FJsonObject> SpecifyAsset = MakeShared<FJsonObject>();
+		SpecifyAsset->SetStringField(TEXT("asset"), PackageNameString + TEXT(".") + FPackageName::GetShortName(PackageNameString));
+		SpecifyAsset->SetBoolField(TEXT("bAnalysisAssetDependencies"), false);
+		SpecifyAsset->SetArrayField(TEXT("assetRegistryDependencyTypes"), TArray<TSharedPtr<FJsonValue>>());
+		return MakeShared<FJsonValueObject>(SpecifyAsset);
+	}
+
+	/** Gets the filenames of the shader libraries the cook of a mod writes for a platform, one per shader format */
+	static void GetShaderLibraryFilenames(const FString& ModName, const ITargetPlatform& TargetPlatform, TArray<FString>& OutFilenames)
+	{
+		TArray<FName> ShaderFormats;
+		TargetPlatform.GetAllTargetedShaderFormats(ShaderFormats);
+
+		for (const FName& ShaderFormat : ShaderFormats)
+		{
+			OutFilenames.Add(FString::Printf(TEXT("ShaderArchive-%s-%s.ushaderbytecode"), *ModName, *ShaderFormat.ToString()));
+		}
+	}
+}
+
 FModPackager::FModPackager()
+	: bGameModsDirty(true)
+	, PackagingQueue(MakeShared<FModPackagingQueue>())
+	, DirtyPackageTracker(MakeUnique<FModDirtyPackageTracker>())
 {
+	IPluginManager::Get().OnNewPluginCreated().AddRaw(this, &FModPackager::HandleNewPlugin);
+	IPluginManager::Get().OnNewPluginMounted().AddRaw(this, &FModPackager::HandleNewPlugin);
+
+	ModsDirectory = FPaths::ConvertRelativePathToFull(FPaths::ProjectModsDir());
+
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get())
+	{
+		DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(ModsDirectory,
+			IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FModPackager::HandleModsDirectoryChanged),
+			ModsDirectoryWatcherHandle,
+			IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges);
+	}
 }
 
 FModPackager::~FModPackager()
 {
+	IPluginManager::Get().OnNewPluginCreated().RemoveAll(this);
+	IPluginManager::Get().OnNewPluginMounted().RemoveAll(this);
+
+	FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	if (DirectoryWatcherModule != nullptr && DirectoryWatcherModule->Get() != nullptr)
+	{
+		DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(ModsDirectory, ModsDirectoryWatcherHandle);
+	}
 }
 
 void FModPackager::OpenPluginPackager(TSharedRef<IPlugin> Plugin)
@@ -66,37 +140,56 @@ void FModPackager::OpenPluginPackager(TSharedRef<IPlugin> Plugin)
 	}
 }
 
-bool FModPackager::IsAllContentSaved(TSharedRef<IPlugin> Plugin)
+bool FModPackager::IsAllContentSaved(TSharedRef<IPlugin> Plugin) const
 {
-	bool bAllContentSaved = true;
-
-	TArray<UPackage*> UnsavedPackages;
-	FEditorFileUtils::GetDirtyContentPackages(UnsavedPackages);
-	FEditorFileUtils::GetDirtyWorldPackages(UnsavedPackages);
+	return !DirtyPackageTracker->HasDirtyPackages(Plugin->GetMountedAssetPath());
+}
 
-	if (UnsavedPackages.Num() > 0)
+void FModPackager::PackagePlugin(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory)
+{
+	if (PackagingQueue->IsQueued(Plugin->GetName()))
 	{
-		FString PluginBaseDir = Plugin->GetBaseDir();
+		FText PackageModError = FText::Format(LOCTEXT("PackageModError_AlreadyQueued", "{0} is already being packaged."),
+			FText::FromString(Plugin->GetName()));
+
+		FMessageDialog::Open(EAppMsgType::Ok, PackageModError);
+		return;
+	}
 
-		for (UPackage* Package : UnsavedPackages)
+	if (GetDefault<UModPackagingSettings>()->bValidateReferences)
+	{
+		TArray<FModReferenceViolation> Violations;
+		if (FModReferenceValidator::Run({ Plugin }, Violations) > 0)
 		{
-			FString PackageFilename;
-			if (FPackageName::TryConvertLongPackageNameToFilename(Package->GetName(), PackageFilename))
+			FText PackageModWarning = FText::Format(LOCTEXT("PackageModWarning_InvalidReferences", "{0} has {1} reference(s) to content it can't rely on once it is installed, e.g. {2} references {3} but {4}.\n\nSee the Output Log for all of them. Package it anyway?"),
+				FText::FromString(Plugin->GetName()), Violations.Num(), FText::FromName(Violations[0].Referencer), FText::FromName(Violations[0].Dependency), FText::FromString(Violations[0].Reason));
+
+			if (FMessageDialog::Open(EAppMsgType::YesNo, PackageModWarning) != EAppReturnType::Yes)
 			{
-				if (PackageFilename.Find(PluginBaseDir) == 0)
-				{
-					bAllContentSaved = false;
-					break;
-				}
+				return;
 			}
 		}
 	}
 
-	return bAllContentSaved;
+	FModPackageOptions Options;
+	GetTargetPlatforms(Options, Options.TargetPlatforms);
+
+	TArray<FString> ConfigFilenames;
+	if (!WritePackageConfig(Plugin, OutputDirectory, Options, ConfigFilenames))
+	{
+		return;
+	}
+
+	PackagingQueue->Enqueue(Plugin->GetName(), Options, ConfigFilenames, OutputDirectory);
 }
 
-void FModPackager::PackagePlugin(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory)
+bool FModPackager::WritePackageConfig(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, TArray<FString>& OutConfigFilenames)
 {
+	OutConfigFilenames.Reset();
+
+	TArray<FString> TargetPlatforms;
+	GetTargetPlatforms(Options, TargetPlatforms);
+
 	FString PackageCofnig;
 	FString PackageCofnigTemplate;
 	PackageCofnigTemplate = IPluginManager::Get().FindPlugin(TEXT("ModSupport"))->GetBaseDir() / TEXT("Resources") / TEXT("ModPackageCofnig.json");
@@ -104,41 +197,560 @@ void FModPackager::PackagePlugin(TSharedRef<class IPlugin> Plugin, const FString
 	if (!FFileHelper::LoadFileToString(PackageCofnig, *PackageCofnigTemplate))
 	{
 		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to load configuration template"));
-		return;
+		return false;
 	}
 
 	PackageCofnig = PackageCofnig.Replace(TEXT("%%%PluginName%%%"), *Plugin->GetName());
 	PackageCofnig = PackageCofnig.Replace(TEXT("%%%PluginContentDir%%%"), *Plugin->GetMountedAssetPath());
 
-#if PLATFORM_WINDOWS
-	PackageCofnig = PackageCofnig.Replace(TEXT("%%%TargetPlatform%%%"), TEXT("WindowsNoEditor"));
-#elif PLATFORM_MAC
-	PackageCofnig = PackageCofnig.Replace(TEXT("%%%TargetPlatform%%%"), TEXT("MacNoEditor"));
-#elif PLATFORM_LINUX
-	PackageCofnig = PackageCofnig.Replace(TEXT("%%%TargetPlatform%%%"), TEXT("LinuxNoEditor"));
-#else
-	PackageCofnig = PackageCofnig.Replace(TEXT("%%%TargetPlatform%%%"), TEXT("AllDesktop"));
-#endif
-
 	PackageCofnig = PackageCofnig.Replace(TEXT("%%%OutputDirectory%%%"), *OutputDirectory);
 
-	FString PackageCofnigSavePath;
-	PackageCofnigSavePath = FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModPackageCofnig.json");
+	TSharedPtr<FJsonObject> ConfigObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(PackageCofnig);
+	if (!FJsonSerializer::Deserialize(Reader, ConfigObject) || !ConfigObject.IsValid())
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to parse configuration template"));
+		return false;
+	}
+
+	if (Options.IncrementalPackages.Num() > 0)
+	{
+		TArray<TSharedPtr<FJsonValue>> SpecifyAssets;
+		for (const FName& PackageName : Options.IncrementalPackages)
+		{
+			SpecifyAssets.Add(ModPackager::MakeSpecifyAsset(PackageName));
+		}
+
+		// Only the changed packages go into a patch pak, which the pak platform file gives precedence over the older paks
+		ConfigObject->SetArrayField(TEXT("assetIncludeFilters"), TArray<TSharedPtr<FJsonValue>>());
+		ConfigObject->SetArrayField(TEXT("includeSpecifyAssets"), SpecifyAssets);
+		ConfigObject->SetStringField(TEXT("versionId"), GetVersionId(Plugin->GetName(), Options));
+	}
+	else if (GetDefault<UModPackagingSettings>()->bEnableChunking)
+	{
+		// Patches stay single paks, the chunk map of the full package still tells which chunk their packages need
+		TArray<FModPackageChunk> Chunks;
+		FModChunker::SplitMod(Plugin, Chunks);
+
+		if (!WriteChunkMap(Plugin, OutputDirectory, Chunks, TargetPlatforms))
+		{
+			return false;
+		}
+
+		if (Chunks.Num() > 0)
+		{
+			TArray<TSharedPtr<FJsonValue>> ChunkInfos;
+			for (const FModPackageChunk& Chunk : Chunks)
+			{
+				TArray<TSharedPtr<FJsonValue>> SpecifyAssets;
+				for (const FName& PackageName : Chunk.Packages)
+				{
+					SpecifyAssets.Add(ModPackager::MakeSpecifyAsset(PackageName));
+				}
+
+				TSharedRef<FJsonObject> ChunkInfo = MakeShared<FJsonObject>();
+				ChunkInfo->SetStringField(TEXT("chunkName"), Chunk.Name);
+				ChunkInfo->SetBoolField(TEXT("bMonolithic"), false);
+				ChunkInfo->SetArrayField(TEXT("assetIncludeFilters"), TArray<TSharedPtr<FJsonValue>>());
+				ChunkInfo->SetArrayField(TEXT("assetIgnoreFilters"), TArray<TSharedPtr<FJsonValue>>());
+				ChunkInfo->SetBoolField(TEXT("bAnalysisFilterDependencies"), false);
+				ChunkInfo->SetArrayField(TEXT("assetRegistryDependencyTypes"), TArray<TSharedPtr<FJsonValue>>());
+				ChunkInfo->SetArrayField(TEXT("includeSpecifyAssets"), SpecifyAssets);
+				ChunkInfo->SetBoolField(TEXT("bForceSkipContent"), false);
+				ChunkInfo->SetArrayField(TEXT("forceSkipContentRules"), TArray<TSharedPtr<FJsonValue>>());
+				ChunkInfo->SetArrayField(TEXT("forceSkipAssets"), TArray<TSharedPtr<FJsonValue>>());
+				ChunkInfos.Add(MakeShared<FJsonValueObject>(ChunkInfo));
+			}
+
+			ConfigObject->SetBoolField(TEXT("bEnableChunk"), true);
+			ConfigObject->SetArrayField(TEXT("chunkInfos"), ChunkInfos);
+
+			// Must match FModChunkMap::GetPakFilename, which the runtime uses to find the optional chunks
+			ConfigObject->SetStringField(TEXT("pakNameRegular"), TEXT("{VERSION}_{CHUNKNAME}"));
+		}
+	}
+
+	if (!WriteAssetRegistry(Plugin, OutputDirectory, Options, TargetPlatforms))
+	{
+		return false;
+	}
+
+	if (!WriteSharedContentMap(Plugin, OutputDirectory, Options, TargetPlatforms))
+	{
+		return false;
+	}
+
+	// Packages a required mod ships byte-identical are loaded from that mod instead, see FModDeduplicator
+	TArray<FName> SharedPackages;
+	FModDeduplicator::GetSharedPackages(Plugin->GetName(), SharedPackages);
+
+	TArray<TSharedPtr<FJsonValue>> ForceSkipAssets;
+	for (const FName& PackageName : SharedPackages)
+	{
+		const FString PackageNameString = PackageName.ToString();
+		ForceSkipAssets.Add(MakeShared<FJsonValueString>(PackageNameString + TEXT(".") + FPackageName::GetShortName(PackageNameString)));
+	}
+
+	TArray<FString> CompressionOptions;
+	GetCompressionOptions(Plugin->GetName(), CompressionOptions);
+
+	TArray<TSharedPtr<FJsonValue>> UnrealPakOptions;
+	for (const FString& Option : CompressionOptions)
+	{
+		UnrealPakOptions.Add(MakeShared<FJsonValueString>(Option));
+	}
+
+	FString OrderFilename;
+	if (WritePakOrderFile(Plugin, OrderFilename))
+	{
+		UnrealPakOptions.Add(MakeShared<FJsonValueString>(FString::Printf(TEXT("-order=\"%s\""), *OrderFilename)));
+	}
+	ConfigObject->SetArrayField(TEXT("unrealPakOptions"), UnrealPakOptions);
+
+	// Everything above is done once for all platforms, only the cook and what depends on the cooked platform is per platform
+	FString SharedPackageCofnig;
+	TSharedRef<TJsonWriter<>> SharedWriter = TJsonWriterFactory<>::Create(&SharedPackageCofnig);
+	FJsonSerializer::Serialize(ConfigObject.ToSharedRef(), SharedWriter);
+
+	for (const FString& TargetPlatform : TargetPlatforms)
+	{
+		PackageCofnig = SharedPackageCofnig.Replace(TEXT("%%%TargetPlatform%%%"), *TargetPlatform);
+
+		TSharedPtr<FJsonObject> PlatformConfigObject;
+		TSharedRef<TJsonReader<>> PlatformReader = TJsonReaderFactory<>::Create(PackageCofnig);
+		if (!FJsonSerializer::Deserialize(PlatformReader, PlatformConfigObject) || !PlatformConfigObject.IsValid())
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to parse configuration for %s"), *TargetPlatform);
+			return false;
+		}
+
+		// Every run cooks the mod for its platform before paking it, which also writes the shader library
+		PlatformConfigObject->SetBoolField(TEXT("bCookPatchAssets"), true);
+
+		// The redirects ship with every platform, the required mod cooks its copy from the same source for each of them
+		PlatformConfigObject->SetArrayField(TEXT("forceSkipAssets"), ForceSkipAssets);
+
+		if (GetDefault<UModPackagingSettings>()->bPackageShaderLibrary)
+		{
+			AddShaderLibrary(Plugin, TargetPlatform, PlatformConfigObject.ToSharedRef());
+		}
+
+		PackageCofnig.Reset();
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&PackageCofnig);
+		FJsonSerializer::Serialize(PlatformConfigObject.ToSharedRef(), Writer);
+
+		// Every mod and platform gets its own configuration, so the cooks of one mod can run next to each other
+		const FString ConfigFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / Plugin->GetName() / TargetPlatform / TEXT("ModPackageCofnig.json");
+
+		if (!FFileHelper::SaveStringToFile(PackageCofnig, *ConfigFilename))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save configuration"));
+			return false;
+		}
+
+		UE_LOG(LogModSupportEditor, Display, TEXT("Saved packaging configuration file to %s"), *ConfigFilename);
+		OutConfigFilenames.Add(ConfigFilename);
+	}
+
+	return true;
+}
+
+bool FModPackager::WritePakOrderFile(TSharedRef<class IPlugin> Plugin, FString& OutOrderFilename)
+{
+	TArray<FString> LoadOrder;
+	if (!FFileHelper::LoadFileToStringArray(LoadOrder, *FModLoadOrderRecorder::GetLoadOrderFilename(Plugin->GetName())) || LoadOrder.Num() == 0)
+	{
+		return false;
+	}
+
+	static const TCHAR* CompanionExtensions[] = { TEXT(".uexp"), TEXT(".ubulk"), TEXT(".uptnl") };
+
+	const FString RootDir = FPaths::ConvertRelativePathToFull(FPaths::RootDir());
+
+	// UnrealPak matches order entries against the staged filenames, which are relative to the root directory
+	TArray<FString> OrderLines;
+	for (const FString& PackageName : LoadOrder)
+	{
+		FString PackageFilename;
+		if (!FPackageName::IsValidLongPackageName(PackageName) || !FPackageName::DoesPackageExist(PackageName, nullptr, &PackageFilename))
+		{
+			// The package was renamed or removed since it was recorded
+			continue;
+		}
+
+		PackageFilename = FPaths::ConvertRelativePathToFull(PackageFilename);
+		FPaths::MakePathRelativeTo(PackageFilename, *RootDir);
+		PackageFilename = TEXT("../../../") + PackageFilename;
+
+		OrderLines.Add(FString::Printf(TEXT("\"%s\" %d"), *PackageFilename, OrderLines.Num() + 1));
+
+		const FString BaseFilename = FPaths::ChangeExtension(PackageFilename, FString());
+		for (const TCHAR* Extension : CompanionExtensions)
+		{
+			OrderLines.Add(FString::Printf(TEXT("\"%s%s\" %d"), *BaseFilename, Extension, OrderLines.Num() + 1));
+		}
+	}
+
+	if (OrderLines.Num() == 0)
+	{
+		return false;
+	}
+
+	OutOrderFilename = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("ModInfo") / Plugin->GetName() / TEXT("PakOrder.txt"));
+
+	if (!FFileHelper::SaveStringArrayToFile(OrderLines, *OutOrderFilename))
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("Failed to save the pak order file of %s"), *Plugin->GetName());
+		return false;
+	}
+
+	return true;
+}
+
+bool FModPackager::WriteChunkMap(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const TArray<FModPackageChunk>& Chunks, const TArray<FString>& TargetPlatforms)
+{
+	FModChunkMap ChunkMap;
+	for (const FModPackageChunk& Chunk : Chunks)
+	{
+		if (Chunk.Name == FModChunker::CoreChunkName)
+		{
+			continue;
+		}
+
+		FModChunk& ChunkEntry = ChunkMap.Chunks.AddDefaulted_GetRef();
+		ChunkEntry.PakFile = FModChunkMap::GetPakFilename(Plugin->GetName(), Chunk.Name);
+		for (const FName& PackageName : Chunk.Packages)
+		{
+			ChunkEntry.Packages.Add(PackageName.ToString());
+		}
+	}
+
+	// HotPatcher writes the paks of a version to <OutputDirectory>/<Version>/<Platform>, the chunk map ships next to them
+	bool bSuccess = true;
+	for (const FString& TargetPlatform : TargetPlatforms)
+	{
+		const FString ChunkMapFilename = OutputDirectory / GetVersionId(Plugin->GetName(), FModPackageOptions()) / TargetPlatform / FModChunkMap::GetFilename();
+
+		if (ChunkMap.Chunks.Num() == 0)
+		{
+			// A mod that is no longer split must not keep the chunk map of an earlier package
+			IFileManager::Get().Delete(*ChunkMapFilename, false, false, true);
+			continue;
+		}
+
+		bSuccess &= ChunkMap.Save(ChunkMapFilename);
+	}
+
+	return bSuccess;
+}
 
-	if (!FFileHelper::SaveStringToFile(PackageCofnig, *PackageCofnigSavePath))
+bool FModPackager::WriteSharedContentMap(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, const TArray<FString>& TargetPlatforms)
+{
+	FModSharedContentMap SharedContentMap;
+	FModDeduplicator::GetSharedContentMap(Plugin->GetName(), SharedContentMap);
+
+	bool bSuccess = true;
+	for (const FString& TargetPlatform : TargetPlatforms)
 	{
-		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save configuration"));
+		const FString Filename = OutputDirectory / GetVersionId(Plugin->GetName(), Options) / TargetPlatform / FModSharedContentMap::GetFilename();
+
+		if (SharedContentMap.Redirects.Num() == 0)
+		{
+			IFileManager::Get().Delete(*Filename, false, false, true);
+			continue;
+		}
+
+		bSuccess &= SharedContentMap.Save(Filename);
+	}
+
+	return bSuccess;
+}
+
+bool FModPackager::WriteAssetRegistry(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, const TArray<FString>& TargetPlatforms)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	// The packaging commandlet doesn't gather the registry up front
+	FString MountedAssetPath = Plugin->GetMountedAssetPath();
+	AssetRegistry.ScanPathsSynchronous({ MountedAssetPath });
+	MountedAssetPath.RemoveFromEnd(TEXT("/"));
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByPath(FName(*MountedAssetPath), Assets, true);
+
+	TSet<FName> ModPackages;
+	for (const FAssetData& Asset : Assets)
+	{
+		ModPackages.Add(Asset.PackageName);
+	}
+
+	// Packages redirected to a required mod are no longer part of the mod
+	TArray<FName> SharedPackages;
+	FModDeduplicator::GetSharedPackages(Plugin->GetName(), SharedPackages);
+	for (const FName& PackageName : SharedPackages)
+	{
+		ModPackages.Remove(PackageName);
+	}
+
+	// Pruning to an empty set keeps everything, which would ship the registry of the whole project with the mod
+	if (ModPackages.Num() == 0)
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("%s has no assets to package"), *Plugin->GetName());
+		return false;
+	}
+
+	for (const FString& TargetPlatformName : TargetPlatforms)
+	{
+		const ITargetPlatform* TargetPlatform = GetTargetPlatformManagerRef().FindTargetPlatform(TargetPlatformName);
+
+		// Each platform filters asset tags by its own ini, like the registry the cook writes for it
+		FAssetRegistrySerializationOptions SerializationOptions;
+		AssetRegistry.InitializeSerializationOptions(SerializationOptions, TargetPlatform != nullptr ? TargetPlatform->IniPlatformName() : FString());
+
+		FAssetRegistryState State;
+		AssetRegistry.InitializeTemporaryAssetRegistryState(State, SerializationOptions);
+		State.PruneAssetData(ModPackages, TSet<FName>(), SerializationOptions);
+
+		TArray<uint8> Bytes;
+		FMemoryWriter Writer(Bytes);
+		State.Serialize(Writer, SerializationOptions);
+
+		const FString Filename = OutputDirectory / GetVersionId(Plugin->GetName(), Options) / TargetPlatformName / FModManager::GetAssetRegistryFilename();
+		if (!FFileHelper::SaveArrayToFile(Bytes, *Filename))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save the asset registry of %s for %s"), *Plugin->GetName(), *TargetPlatformName);
+			return false;
+		}
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Saved the asset registry of %d package(s) of %s for %d platform(s)"), ModPackages.Num(), *Plugin->GetName(), TargetPlatforms.Num());
+	return true;
+}
+
+FString FModPackager::GetVersionId(const FString& ModName, const FModPackageOptions& Options)
+{
+	return Options.IncrementalPackages.Num() > 0 ? FString::Printf(TEXT("%s_%d_P"), *ModName, Options.PatchIndex) : ModName;
+}
+
+bool FModPackager::WritePakManifest(const FString& ModName, const FString& OutputDirectory, const FModPackageOptions& Options, const FString& TargetPlatform)
+{
+	const FString PakDir = OutputDirectory / GetVersionId(ModName, Options) / TargetPlatform;
+
+	TArray<FString> PakFiles;
+	IFileManager::Get().FindFiles(PakFiles, *PakDir, TEXT("pak"));
+	for (FString& PakFile : PakFiles)
+	{
+		PakFile = PakDir / PakFile;
+	}
+
+	// The paks of a patch are installed next to those of the earlier releases, so its manifest has to cover all of them
+	const FString ReleasePakManifestFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TargetPlatform / FModPakManifest::GetFilename();
+
+	FModPakManifest PakManifest;
+	if (Options.IncrementalPackages.Num() > 0)
+	{
+		PakManifest.Load(ReleasePakManifestFilename);
+	}
+
+	if (!PakManifest.Build(PakFiles))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to hash the paks of %s"), *ModName);
+		return false;
+	}
+
+	return PakManifest.Save(PakDir / FModPakManifest::GetFilename()) && PakManifest.Save(ReleasePakManifestFilename);
+}
+
+bool FModPackager::WritePakDeltas(const FString& ModName, const FString& OutputDirectory, const FString& PreviousOutputDirectory, const FModPackageOptions& Options, const FString& TargetPlatform)
+{
+	const FString RelativePakDir = GetVersionId(ModName, Options) / TargetPlatform;
+	const FString PakDir = OutputDirectory / RelativePakDir;
+	const FString PreviousPakDir = PreviousOutputDirectory / RelativePakDir;
+
+	TArray<FString> PakFiles;
+	IFileManager::Get().FindFiles(PakFiles, *PakDir, TEXT("pak"));
+
+	bool bSuccess = true;
+	for (const FString& PakFile : PakFiles)
+	{
+		// A pak the earlier release didn't ship has nothing to be a delta of and is downloaded as a whole
+		if (!IFileManager::Get().FileExists(*(PreviousPakDir / PakFile)))
+		{
+			continue;
+		}
+
+		const FString DeltaFile = PakDir / PakFile + TEXT(".") + FModPakDelta::GetExtension();
+		bSuccess &= FModPakDelta::Create(PreviousPakDir / PakFile, PakDir / PakFile, DeltaFile);
+	}
+
+	return bSuccess;
+}
+
+FString FModPackager::GetCookedContentDir(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatform)
+{
+	// Cooked content of a mod keeps its path relative to the project directory
+	FString RelativeContentDir = FPaths::ConvertRelativePathToFull(Plugin->GetContentDir());
+	FPaths::MakePathRelativeTo(RelativeContentDir, *FPaths::ConvertRelativePathToFull(FPaths::ProjectDir()));
+
+	return FPaths::ProjectSavedDir() / TEXT("Cooked") / TargetPlatform / FApp::GetProjectName() / RelativeContentDir;
+}
+
+void FModPackager::AddShaderLibrary(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatformName, const TSharedRef<FJsonObject>& ConfigObject)
+{
+	const ITargetPlatform* TargetPlatform = GetTargetPlatformManagerRef().FindTargetPlatform(TargetPlatformName);
+	if (TargetPlatform == nullptr)
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("Unknown target platform %s, %s is packaged without a shader library"), *TargetPlatformName, *Plugin->GetName());
 		return;
 	}
 
+	// The project's shader library is shipped by the game, the mod only needs the shaders of its own materials
+	TSharedRef<FJsonObject> CookShaderOptions = MakeShared<FJsonObject>();
+	CookShaderOptions->SetBoolField(TEXT("bSharedShaderLibrary"), true);
+	CookShaderOptions->SetBoolField(TEXT("bNativeShader"), false);
+	CookShaderOptions->SetStringField(TEXT("shaderLibraryName"), Plugin->GetName());
+	ConfigObject->SetObjectField(TEXT("cookShaderOptions"), CookShaderOptions);
+	ConfigObject->SetBoolField(TEXT("bIncludeShaderBytecode"), false);
+
+	// Stage the library where FModManager looks for it, see FModManager::OpenShaderLibrary_Locked
+	FString MountDir = FPaths::ConvertRelativePathToFull(Plugin->GetContentDir());
+	FPaths::MakePathRelativeTo(MountDir, *FPaths::ConvertRelativePathToFull(FPaths::RootDir()));
+	MountDir = TEXT("../../../") + MountDir;
+
+	const FString CookedContentDir = GetCookedContentDir(Plugin, TargetPlatformName);
+
+	TArray<FString> LibraryFilenames;
+	ModPackager::GetShaderLibraryFilenames(Plugin->GetName(), *TargetPlatform, LibraryFilenames);
+
+	TArray<TSharedPtr<FJsonValue>> ExternFiles;
+	for (const FString& LibraryFilename : LibraryFilenames)
+	{
+		// A library left over from an earlier cook must not pass for the one this cook writes, see VerifyShaderLibrary
+		IFileManager::Get().Delete(*(CookedContentDir / LibraryFilename), false, true, true);
+
+		TSharedRef<FJsonObject> FilePath = MakeShared<FJsonObject>();
+		FilePath->SetStringField(TEXT("filePath"), FPaths::ConvertRelativePathToFull(CookedContentDir / LibraryFilename));
+
+		TSharedRef<FJsonObject> ExternFile = MakeShared<FJsonObject>();
+		ExternFile->SetObjectField(TEXT("filePath"), FilePath);
+		ExternFile->SetStringField(TEXT("mountPath"), MountDir / LibraryFilename);
+		ExternFiles.Add(MakeShared<FJsonValueObject>(ExternFile));
+	}
+
+	TSharedRef<FJsonObject> PlatformExternAssets = MakeShared<FJsonObject>();
+	PlatformExternAssets->SetStringField(TEXT("targetPlatform"), TargetPlatformName);
+	PlatformExternAssets->SetArrayField(TEXT("addExternFileToPak"), ExternFiles);
+	PlatformExternAssets->SetArrayField(TEXT("addExternDirectoryToPak"), TArray<TSharedPtr<FJsonValue>>());
+
+	TArray<TSharedPtr<FJsonValue>> ExternAssets = ConfigObject->GetArrayField(TEXT("addExternAssetsToPlatform"));
+	ExternAssets.Add(MakeShared<FJsonValueObject>(PlatformExternAssets));
+	ConfigObject->SetArrayField(TEXT("addExternAssetsToPlatform"), ExternAssets);
+}
+
+bool FModPackager::VerifyCookedContent(const FString& ModName, const FString& TargetPlatform, const FDateTime& StartTime)
+{
+	TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(ModName);
+	if (!Plugin.IsValid())
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Unknown mod %s"), *ModName);
+		return false;
+	}
+
+	// Some file systems only store timestamps to the nearest two seconds
+	const FDateTime MinTimestamp = StartTime - FTimespan::FromSeconds(2.0);
+
+	const FString CookedContentDir = GetCookedContentDir(Plugin.ToSharedRef(), TargetPlatform);
+
+	bool bCooked = false;
+	IFileManager::Get().IterateDirectoryStatRecursively(*CookedContentDir, [MinTimestamp, &bCooked](const TCHAR* Filename, const FFileStatData& StatData)
+	{
+		bCooked = !StatData.bIsDirectory && StatData.ModificationTime >= MinTimestamp;
+		return !bCooked;
+	});
+
+	if (!bCooked)
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("%s wasn't cooked for %s, nothing in %s was written by the run"), *ModName, *TargetPlatform, *CookedContentDir);
+		return false;
+	}
+
+	return true;
+}
+
+bool FModPackager::VerifyShaderLibrary(const FString& ModName, const FString& TargetPlatformName)
+{
+	if (!GetDefault<UModPackagingSettings>()->bPackageShaderLibrary)
+	{
+		return true;
+	}
+
+	TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(ModName);
+	const ITargetPlatform* TargetPlatform = GetTargetPlatformManagerRef().FindTargetPlatform(TargetPlatformName);
+	if (!Plugin.IsValid() || TargetPlatform == nullptr)
+	{
+		// AddShaderLibrary didn't add a library for an unknown platform either
+		return true;
+	}
+
+	const FString CookedContentDir = GetCookedContentDir(Plugin.ToSharedRef(), TargetPlatformName);
+
+	TArray<FString> LibraryFilenames;
+	ModPackager::GetShaderLibraryFilenames(ModName, *TargetPlatform, LibraryFilenames);
+
+	bool bSuccess = true;
+	for (const FString& LibraryFilename : LibraryFilenames)
+	{
+		if (!IFileManager::Get().FileExists(*(CookedContentDir / LibraryFilename)))
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("The cook of %s for %s didn't write %s, its paks ship without it"), *ModName, *TargetPlatformName, *LibraryFilename);
+			bSuccess = false;
+		}
+	}
+
+	return bSuccess;
+}
+
+void FModPackager::GetCompressionOptions(const FString& ModName, TArray<FString>& OutOptions)
+{
+	const FModCompressionProfile& CompressionProfile = GetDefault<UModPackagingSettings>()->GetCompressionProfile(ModName);
+
+	OutOptions.Add(TEXT("-compress"));
+	OutOptions.Add(TEXT("-compressionformats=") + CompressionProfile.CompressionFormat.ToString());
+	OutOptions.Add(FString::Printf(TEXT("-compressionblocksize=%d"), CompressionProfile.CompressionBlockSize));
+	// -blocksize only keeps small files from straddling file system blocks, this pads the start of every file
+	if (CompressionProfile.PakAlignment > 0)
+	{
+		OutOptions.Add(FString::Printf(TEXT("-patchpaddingalign=%d"), CompressionProfile.PakAlignment));
+	}
+}
+
+void FModPackager::GetTargetPlatforms(const FModPackageOptions& Options, TArray<FString>& OutTargetPlatforms)
+{
+	OutTargetPlatforms = Options.TargetPlatforms.Num() > 0 ? Options.TargetPlatforms : GetDefault<UModPackagingSettings>()->TargetPlatforms;
+
+	if (OutTargetPlatforms.Num() == 0)
+	{
+		OutTargetPlatforms.Add(GetHostTargetPlatform());
+	}
+}
+
+FString FModPackager::GetHostTargetPlatform()
+{
 #if PLATFORM_WINDOWS
-	PackageCofnigSavePath = PackageCofnigSavePath.Replace(TEXT("/"), TEXT("\\"));
+	return TEXT("WindowsNoEditor");
+#elif PLATFORM_MAC
+	return TEXT("MacNoEditor");
+#elif PLATFORM_LINUX
+	return TEXT("LinuxNoEditor");
+#else
+	return TEXT("AllDesktop");
 #endif
+}
 
-	FText OptTitle = LOCTEXT("PackageCofnigDialog", "Saved packaging configuration file");
-	FText Message = FText::FromString(PackageCofnigSavePath);
-	FMessageDialog::Open(EAppMsgType::Ok, Message, &OptTitle);
-	UE_LOG(LogModSupportEditor, Display, TEXT("Saved packaging configuration file to %s"), *PackageCofnigSavePath);
+FString FModPackager::GetPackageCommandLine(const FString& ConfigFilename)
+{
+	return FString::Printf(TEXT("\"%s\" -run=HotPatcher -config=\"%s\" -unattended -nopause -nosplash -stdout -FullStdOutLogOutput"),
+		*FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()), *FPaths::ConvertRelativePathToFull(ConfigFilename));
 }
 
 void FModPackager::FindAvailableGameMods(TArray<TSharedRef<IPlugin>>& OutAvailableGameMods)
@@ -149,40 +761,73 @@ void FModPackager::FindAvailableGameMods(TArray<TSharedRef<IPlugin>>& OutAvailab
 	{
 		if (Plugin->GetLoadedFrom() == EPluginLoadedFrom::Project && Plugin->GetType() == EPluginType::Mod)
 		{
-			UE_LOG(LogModSupportEditor, Display, TEXT("Adding %s"), *Plugin->GetName());
+			UE_LOG(LogModSupportEditor, Verbose, TEXT("Adding %s"), *Plugin->GetName());
 			OutAvailableGameMods.AddUnique(Plugin);
 		}
 	}
 }
 
-void FModPackager::GeneratePackagerMenuContent_Internal(class FMenuBuilder& MenuBuilder, const TArray<TSharedPtr<FUICommandInfo>>& Commands)
+void FModPackager::GeneratePackagerMenuContent_Internal(class FMenuBuilder& MenuBuilder, const TArray<TSharedPtr<FUICommandInfo>>& Commands, const TArray<TSharedRef<IPlugin>>& Mods)
 {
-	for (TSharedPtr<FUICommandInfo> Command : Commands)
+	for (int32 Index = 0; Index < Commands.Num(); ++Index)
 	{
-		MenuBuilder.AddMenuEntry(Command, NAME_None, TAttribute<FText>(), TAttribute<FText>(), FSlateIcon(FModSupportEditorStyle::GetStyleSetName(), "ModSupportEditor.Folder"));
+		// The label is evaluated while the menu is open, so it follows the dirty state of the mod live
+		TAttribute<FText> Label = TAttribute<FText>::Create(TAttribute<FText>::FGetter::CreateSP(this, &FModPackager::GetModMenuLabel, Mods[Index]));
+
+		MenuBuilder.AddMenuEntry(Commands[Index], NAME_None, Label, TAttribute<FText>(), FSlateIcon(FModSupportEditorStyle::GetStyleSetName(), "ModSupportEditor.Folder"));
 	}
 }
 
-void FModPackager::GeneratePackagerMenuContent(class FMenuBuilder& MenuBuilder)
+FText FModPackager::GetModMenuLabel(TSharedRef<IPlugin> Mod) const
 {
-	TArray<TSharedRef<IPlugin>> AvailableGameMods;
-	FindAvailableGameMods(AvailableGameMods);
+	if (IsAllContentSaved(Mod))
+	{
+		return FText::FromString(Mod->GetName());
+	}
 
-	TArray<TSharedPtr<FUICommandInfo>> Commands;
+	return FText::Format(LOCTEXT("PackageMod_UnsavedLabel", "{0} (unsaved)"), FText::FromString(Mod->GetName()));
+}
+
+void FModPackager::GeneratePackagerMenuContent(class FMenuBuilder& MenuBuilder)
+{
+	UpdateAvailableGameMods();
 
-	GeneratePackagerMenuContent_Internal(MenuBuilder, ModCommands);
+	GeneratePackagerMenuContent_Internal(MenuBuilder, ModCommands, AvailableGameMods);
 }
 
 TSharedRef<SWidget> FModPackager::GeneratePackagerComboButtonContent()
 {
+	UpdateAvailableGameMods();
+
+	// Show the drop down menu
+	const bool bShouldCloseWindowAfterMenuSelection = true;
+	FMenuBuilder MenuBuilder(bShouldCloseWindowAfterMenuSelection, GameModActionsList);
+
+	MenuBuilder.BeginSection(NAME_None, LOCTEXT("PackageMod", "Share..."));
+	{
+		GeneratePackagerMenuContent_Internal(MenuBuilder, ModCommands, AvailableGameMods);
+	}
+	MenuBuilder.EndSection();
+
+	return MenuBuilder.MakeWidget();
+}
+
+void FModPackager::UpdateAvailableGameMods()
+{
+	if (!bGameModsDirty)
+	{
+		return;
+	}
+
+	bGameModsDirty = false;
+
 	// Regenerate the game mod commands
-	TArray<TSharedRef<IPlugin>> AvailableGameMods;
 	FindAvailableGameMods(AvailableGameMods);
 
 	GetAvailableModCommands(AvailableGameMods);
 
 	// Regenerate the action list
-	TSharedPtr<FUICommandList> GameModActionsList = MakeShareable(new FUICommandList);
+	GameModActionsList = MakeShareable(new FUICommandList);
 
 	for (int32 Index = 0; Index < ModCommands.Num(); ++Index)
 	{
@@ -192,18 +837,31 @@ TSharedRef<SWidget> FModPackager::GeneratePackagerComboButtonContent()
 			FCanExecuteAction()
 		);
 	}
+}
 
-	// Show the drop down menu
-	const bool bShouldCloseWindowAfterMenuSelection = true;
-	FMenuBuilder MenuBuilder(bShouldCloseWindowAfterMenuSelection, GameModActionsList);
+void FModPackager::HandleNewPlugin(IPlugin& Plugin)
+{
+	bGameModsDirty = true;
+}
 
-	MenuBuilder.BeginSection(NAME_None, LOCTEXT("PackageMod", "Share..."));
+void FModPackager::HandleModsDirectoryChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	bool bDescriptorsChanged = false;
+	for (const FFileChangeData& FileChange : FileChanges)
 	{
-		GeneratePackagerMenuContent_Internal(MenuBuilder, ModCommands);
+		if (FPaths::GetExtension(FileChange.Filename) == TEXT("uplugin"))
+		{
+			bDescriptorsChanged = true;
+			break;
+		}
 	}
-	MenuBuilder.EndSection();
 
-	return MenuBuilder.MakeWidget();
+	// Content changes inside a mod don't change the list of mods
+	if (bDescriptorsChanged)
+	{
+		IPluginManager::Get().RefreshPluginsList();
+		bGameModsDirty = true;
+	}
 }
 
 void FModPackager::GetAvailableModCommands(const TArray<TSharedRef<IPlugin>>& AvailableMod)
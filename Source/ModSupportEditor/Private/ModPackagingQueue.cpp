@@ -0,0 +1,319 @@
+#include "ModPackagingQueue.h"
+
+#include "ModSupportEditorLog.h"
+#include "Async/Async.h"
+#include "Framework/Docking/TabManager.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/MonitoredProcess.h"
+#include "Misc/ScopeLock.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "ModPackagingQueue"
+
+FModPackagingQueue::~FModPackagingQueue()
+{
+	// The processes would keep packaging with nobody left to finish their mods
+	for (const TSharedRef<FJob>& Job : Jobs)
+	{
+		for (FPlatformCook& Cook : Job->Cooks)
+		{
+			if (Cook.Process.IsValid() && !Cook.bFinished)
+			{
+				Cook.Process->OnCompleted().Unbind();
+				Cook.Process->OnCanceled().Unbind();
+				Cook.Process->OnOutput().Unbind();
+				Cook.Process->Cancel(true);
+			}
+		}
+	}
+}
+
+bool FModPackagingQueue::Enqueue(const FString& ModName, const FModPackageOptions& Options, const TArray<FString>& ConfigFilenames, const FString& OutputDirectory)
+{
+	if (IsQueued(ModName))
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("%s is already being packaged"), *ModName);
+		return false;
+	}
+
+	TArray<FString> TargetPlatforms;
+	FModPackager::GetTargetPlatforms(Options, TargetPlatforms);
+	check(TargetPlatforms.Num() == ConfigFilenames.Num());
+
+	TSharedRef<FJob> Job = MakeShared<FJob>();
+	Job->ModName = ModName;
+	Job->Options = Options;
+	Job->OutputDirectory = OutputDirectory;
+
+	for (int32 Index = 0; Index < TargetPlatforms.Num(); ++Index)
+	{
+		FPlatformCook& Cook = Job->Cooks.AddDefaulted_GetRef();
+		Cook.TargetPlatform = TargetPlatforms[Index];
+		Cook.ConfigFilename = ConfigFilenames[Index];
+	}
+
+	FNotificationInfo Info(TAttribute<FText>::Create(TAttribute<FText>::FGetter::CreateSP(this, &FModPackagingQueue::GetJobText, TWeakPtr<FJob>(Job))));
+	Info.bFireAndForget = false;
+	Info.ExpireDuration = 5.0f;
+	Info.Hyperlink = FSimpleDelegate::CreateLambda([]()
+	{
+		FGlobalTabmanager::Get()->InvokeTab(FName(TEXT("OutputLog")));
+	});
+	Info.HyperlinkText = LOCTEXT("ShowOutputLog", "Show Output Log");
+	Info.ButtonDetails.Add(FNotificationButtonInfo(
+		LOCTEXT("CancelPackaging", "Cancel"),
+		LOCTEXT("CancelPackagingTooltip", "Stop packaging this mod"),
+		FSimpleDelegate::CreateSP(this, &FModPackagingQueue::Cancel, ModName),
+		SNotificationItem::CS_Pending));
+
+	Job->Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Job->Notification.IsValid())
+	{
+		Job->Notification->SetCompletionState(SNotificationItem::CS_Pending);
+	}
+
+	Jobs.Add(Job);
+	StartNextJob();
+	return true;
+}
+
+bool FModPackagingQueue::IsQueued(const FString& ModName) const
+{
+	return Jobs.ContainsByPredicate([&ModName](const TSharedRef<FJob>& Job)
+	{
+		return Job->ModName == ModName;
+	});
+}
+
+void FModPackagingQueue::Cancel(const FString& ModName)
+{
+	const int32 Index = Jobs.IndexOfByPredicate([&ModName](const TSharedRef<FJob>& Job)
+	{
+		return Job->ModName == ModName;
+	});
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	TSharedRef<FJob> Job = Jobs[Index];
+	Job->bCanceled = true;
+
+	if (!Job->bStarted)
+	{
+		HandleJobCompleted(Job);
+		return;
+	}
+
+	// Every cook completes through OnCanceled, the last one completes the job
+	for (FPlatformCook& Cook : Job->Cooks)
+	{
+		if (Cook.Process.IsValid() && !Cook.bFinished)
+		{
+			Cook.Process->Cancel(true);
+		}
+	}
+}
+
+void FModPackagingQueue::StartNextJob()
+{
+	if (Jobs.Num() == 0 || Jobs[0]->bStarted)
+	{
+		return;
+	}
+
+	TSharedRef<FJob> Job = Jobs[0];
+	Job->bStarted = true;
+	Job->StartTime = FPlatformTime::Seconds();
+
+	TWeakPtr<FModPackagingQueue> WeakThis = AsShared();
+	TWeakPtr<FJob> WeakJob = Job;
+
+	// The platforms don't share any output, so they are cooked by concurrent processes
+	for (int32 CookIndex = 0; CookIndex < Job->Cooks.Num(); ++CookIndex)
+	{
+		FPlatformCook& Cook = Job->Cooks[CookIndex];
+		Cook.Process = MakeShared<FMonitoredProcess>(FPlatformProcess::ExecutablePath(), FModPackager::GetPackageCommandLine(Cook.ConfigFilename), true);
+
+		// The delegates of the process are called on the thread monitoring it
+		const FString TargetPlatform = Cook.TargetPlatform;
+		Cook.Process->OnOutput().BindLambda([WeakJob, TargetPlatform](FString Output)
+		{
+			if (TSharedPtr<FJob> PinnedJob = WeakJob.Pin())
+			{
+				UE_LOG(LogModSupportEditor, Log, TEXT("%s (%s): %s"), *PinnedJob->ModName, *TargetPlatform, *Output);
+
+				FScopeLock Lock(&PinnedJob->OutputCritical);
+				PinnedJob->LastOutput = FString::Printf(TEXT("[%s] %s"), *TargetPlatform, *Output);
+			}
+		});
+		// The job owns the process, so the delegates only hold it weakly
+		Cook.Process->OnCompleted().BindLambda([WeakThis, WeakJob, CookIndex](int32 ReturnCode)
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, WeakJob, CookIndex, ReturnCode]()
+			{
+				TSharedPtr<FModPackagingQueue> This = WeakThis.Pin();
+				TSharedPtr<FJob> PinnedJob = WeakJob.Pin();
+				if (This.IsValid() && PinnedJob.IsValid())
+				{
+					This->HandleCookCompleted(PinnedJob.ToSharedRef(), CookIndex, ReturnCode);
+				}
+			});
+		});
+		Cook.Process->OnCanceled().BindLambda([WeakThis, WeakJob, CookIndex]()
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, WeakJob, CookIndex]()
+			{
+				TSharedPtr<FModPackagingQueue> This = WeakThis.Pin();
+				TSharedPtr<FJob> PinnedJob = WeakJob.Pin();
+				if (This.IsValid() && PinnedJob.IsValid())
+				{
+					This->HandleCookCompleted(PinnedJob.ToSharedRef(), CookIndex, -1);
+				}
+			});
+		});
+	}
+
+	TArray<int32> FailedCooks;
+	for (int32 CookIndex = 0; CookIndex < Job->Cooks.Num(); ++CookIndex)
+	{
+		FPlatformCook& Cook = Job->Cooks[CookIndex];
+		Cook.LaunchTime = FDateTime::UtcNow();
+
+		if (Cook.Process->Launch())
+		{
+			UE_LOG(LogModSupportEditor, Display, TEXT("Started packaging %s for %s"), *Job->ModName, *Cook.TargetPlatform);
+		}
+		else
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("Failed to start packaging %s for %s"), *Job->ModName, *Cook.TargetPlatform);
+			FailedCooks.Add(CookIndex);
+		}
+	}
+
+	// Completed once every cook was launched, the last completion finishes the job and starts the next one
+	for (int32 CookIndex : FailedCooks)
+	{
+		HandleCookCompleted(Job, CookIndex, -1);
+	}
+}
+
+void FModPackagingQueue::HandleCookCompleted(TSharedRef<FJob> Job, int32 CookIndex, int32 ReturnCode)
+{
+	check(IsInGameThread());
+
+	FPlatformCook& Cook = Job->Cooks[CookIndex];
+	if (Cook.bFinished)
+	{
+		return;
+	}
+
+	Cook.bFinished = true;
+	Cook.bSucceeded = !Job->bCanceled && ReturnCode == 0
+		&& FModPackager::VerifyCookedContent(Job->ModName, Cook.TargetPlatform, Cook.LaunchTime)
+		&& FModPackager::VerifyShaderLibrary(Job->ModName, Cook.TargetPlatform)
+		&& FModPackager::WritePakManifest(Job->ModName, Job->OutputDirectory, Job->Options, Cook.TargetPlatform);
+
+	if (!Cook.bSucceeded && !Job->bCanceled)
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to package %s for %s, exit code %d"), *Job->ModName, *Cook.TargetPlatform, ReturnCode);
+	}
+
+	const bool bAllFinished = !Job->Cooks.ContainsByPredicate([](const FPlatformCook& OtherCook)
+	{
+		return !OtherCook.bFinished;
+	});
+
+	if (bAllFinished)
+	{
+		HandleJobCompleted(Job);
+	}
+}
+
+void FModPackagingQueue::HandleJobCompleted(TSharedRef<FJob> Job)
+{
+	check(IsInGameThread());
+
+	Jobs.Remove(Job);
+
+	const bool bSuccess = !Job->bCanceled && !Job->Cooks.ContainsByPredicate([](const FPlatformCook& Cook)
+	{
+		return !Cook.bSucceeded;
+	});
+
+	if (Job->bCanceled)
+	{
+		UE_LOG(LogModSupportEditor, Display, TEXT("Canceled packaging %s"), *Job->ModName);
+	}
+	else if (bSuccess)
+	{
+		UE_LOG(LogModSupportEditor, Display, TEXT("Packaged %s for %d platform(s) to %s"), *Job->ModName, Job->Cooks.Num(), *Job->OutputDirectory);
+	}
+
+	if (Job->Notification.IsValid())
+	{
+		const FText ModName = FText::FromString(Job->ModName);
+
+		FText Result;
+		if (Job->bCanceled)
+		{
+			Result = FText::Format(LOCTEXT("PackagingCanceled", "Packaging {0} was canceled"), ModName);
+		}
+		else if (bSuccess)
+		{
+			Result = FText::Format(LOCTEXT("PackagingSucceeded", "Packaged {0}"), ModName);
+		}
+		else
+		{
+			Result = FText::Format(LOCTEXT("PackagingFailed", "Failed to package {0}"), ModName);
+		}
+
+		Job->Notification->SetText(Result);
+		Job->Notification->SetCompletionState(bSuccess ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+		Job->Notification->ExpireAndFadeout();
+		Job->Notification.Reset();
+	}
+
+	StartNextJob();
+}
+
+FText FModPackagingQueue::GetJobText(TWeakPtr<FJob> WeakJob) const
+{
+	TSharedPtr<FJob> Job = WeakJob.Pin();
+	if (!Job.IsValid())
+	{
+		return FText::GetEmpty();
+	}
+
+	const FText ModName = FText::FromString(Job->ModName);
+
+	if (!Job->bStarted)
+	{
+		const int32 NumAhead = Jobs.IndexOfByPredicate([&Job](const TSharedRef<FJob>& QueuedJob)
+		{
+			return QueuedJob == Job;
+		});
+
+		return FText::Format(LOCTEXT("PackagingQueued", "{0} is waiting to be packaged ({1} ahead)"), ModName, FMath::Max(NumAhead, 0));
+	}
+
+	int32 NumFinished = 0;
+	for (const FPlatformCook& Cook : Job->Cooks)
+	{
+		NumFinished += Cook.bFinished ? 1 : 0;
+	}
+
+	FString LastOutput;
+	{
+		FScopeLock Lock(&Job->OutputCritical);
+		LastOutput = Job->LastOutput;
+	}
+
+	const FTimespan Elapsed = FTimespan::FromSeconds(FPlatformTime::Seconds() - Job->StartTime);
+
+	return FText::Format(LOCTEXT("PackagingRunning", "Packaging {0}, {1} of {2} platform(s) done ({3})\n{4}"),
+		ModName, NumFinished, Job->Cooks.Num(), FText::AsTimespan(Elapsed), FText::FromString(LastOutput.Left(120)));
+}
+
+#undef LOCTEXT_NAMESPACE
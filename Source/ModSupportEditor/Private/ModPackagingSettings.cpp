@@ -0,0 +1,19 @@
+#include "ModPackagingSettings.h"
+
+UModPackagingSettings::UModPackagingSettings()
+	: BenchmarkCompressionFormats({ NAME_Zlib, NAME_Gzip, NAME_LZ4 })
+	, BenchmarkCompressionBlockSizes({ 64 * 1024, 256 * 1024 })
+	, BenchmarkSampleSize(64 * 1024 * 1024)
+	, bEnableChunking(false)
+	, MinChunkingSizeMB(512)
+	, TargetChunkSizeMB(256)
+	, bPackageShaderLibrary(true)
+	, bValidateReferences(true)
+{
+}
+
+const FModCompressionProfile& UModPackagingSettings::GetCompressionProfile(const FString& ModName) const
+{
+	const FModCompressionProfile* Profile = ModCompressionProfiles.Find(ModName);
+	return Profile != nullptr ? *Profile : DefaultCompressionProfile;
+}
@@ -0,0 +1,373 @@
+#include "ModReferenceValidator.h"
+
+#include "ModManager.h"
+#include "ModPackager.h"
+#include "ModSupportEditorLog.h"
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "PluginDescriptor.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ModReferenceValidator
+{
+	static const uint32 Magic = 0x4452524D; // 'MRRD'
+
+	/** Bump whenever the layout of the cache changes */
+	static const int32 Version = 2;
+
+	/** A package of a mod and the packages it references */
+	struct FPackage
+	{
+		int64 Size = 0;
+		FDateTime Timestamp;
+
+		/** Packages loaded along with the package */
+		TArray<FName> HardDependencies;
+
+		/** Packages only loaded once the package asks for them, like soft object paths */
+		TArray<FName> SoftDependencies;
+
+		/** Package file on disk, only set while validating */
+		FString Filename;
+
+		friend FArchive& operator<<(FArchive& Ar, FPackage& Package)
+		{
+			return Ar << Package.Size << Package.Timestamp << Package.HardDependencies << Package.SoftDependencies;
+		}
+	};
+
+	/** The dependency graph of a mod and what it may reference */
+	struct FModGraph
+	{
+		FString ModName;
+
+		/** Directory of the source content, ending in a slash */
+		FString ContentDir;
+
+		/** Mount point of the content, e.g. /MyMod/ */
+		FString MountedAssetPath;
+
+		/** Mount point roots the mod may reference */
+		TSet<FString> AllowedRoots;
+
+		/** Packages of the mod by package name, as cached until they were scanned */
+		TMap<FName, FPackage> Packages;
+
+		/** Packages whose file changed since the cache was saved */
+		TArray<FName> ChangedPackages;
+
+		bool bCacheDirty = false;
+
+		/** Hard references that leave the allowed content, which fail the mod */
+		TArray<FModReferenceViolation> Violations;
+
+		/** Soft references that leave the allowed content, which are only reported */
+		TArray<FModReferenceViolation> SoftViolations;
+	};
+
+	static void LoadCache(FModGraph& Graph)
+	{
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *FModReferenceValidator::GetCacheFilename(Graph.ModName), FILEREAD_Silent))
+		{
+			return;
+		}
+
+		FMemoryReader Reader(Data);
+
+		uint32 CacheMagic = 0;
+		int32 CacheVersion = 0;
+		Reader << CacheMagic << CacheVersion;
+
+		if (CacheMagic == Magic && CacheVersion == Version)
+		{
+			Reader << Graph.Packages;
+		}
+
+		if (Reader.IsError() || CacheMagic != Magic || CacheVersion != Version)
+		{
+			UE_LOG(LogModSupportEditor, Log, TEXT("Ignoring outdated reference cache of %s, all of its packages are scanned"), *Graph.ModName);
+			Graph.Packages.Reset();
+		}
+	}
+
+	static void SaveCache(FModGraph& Graph)
+	{
+		TArray<uint8> Data;
+		FMemoryWriter Writer(Data);
+
+		uint32 CacheMagic = Magic;
+		int32 CacheVersion = Version;
+		Writer << CacheMagic << CacheVersion;
+		Writer << Graph.Packages;
+
+		const FString CacheFilename = FModReferenceValidator::GetCacheFilename(Graph.ModName);
+		if (!FFileHelper::SaveArrayToFile(Data, *CacheFilename))
+		{
+			UE_LOG(LogModSupportEditor, Warning, TEXT("Failed to save %s"), *CacheFilename);
+		}
+	}
+
+	/** Finds the packages of a mod on disk and keeps the cached dependencies of every package whose file didn't change. Safe to call from any thread */
+	static void ScanPackages(FModGraph& Graph)
+	{
+		TMap<FName, FPackage> CachedPackages = MoveTemp(Graph.Packages);
+		Graph.Packages.Reset();
+
+		IFileManager::Get().IterateDirectoryStatRecursively(*Graph.ContentDir, [&Graph, &CachedPackages](const TCHAR* Filename, const FFileStatData& StatData)
+		{
+			const FString Extension = FPaths::GetExtension(Filename, true);
+			if (StatData.bIsDirectory || (Extension != FPackageName::GetAssetPackageExtension() && Extension != FPackageName::GetMapPackageExtension()))
+			{
+				return true;
+			}
+
+			// Built from the path instead of asking FPackageName, whose mount points belong to the game thread
+			FString RelativePath = FPaths::GetBaseFilename(Filename, false);
+			FPaths::MakePathRelativeTo(RelativePath, *Graph.ContentDir);
+			const FName PackageName(*(Graph.MountedAssetPath + RelativePath));
+
+			FPackage Package;
+			if (CachedPackages.RemoveAndCopyValue(PackageName, Package) && Package.Size == StatData.FileSize && Package.Timestamp == StatData.ModificationTime)
+			{
+				Package.Filename = Filename;
+				Graph.Packages.Add(PackageName, MoveTemp(Package));
+				return true;
+			}
+
+			FPackage& ChangedPackage = Graph.Packages.Add(PackageName);
+			ChangedPackage.Size = StatData.FileSize;
+			ChangedPackage.Timestamp = StatData.ModificationTime;
+			ChangedPackage.Filename = Filename;
+
+			Graph.ChangedPackages.Add(PackageName);
+			Graph.bCacheDirty = true;
+			return true;
+		});
+
+		// Cached packages that weren't found were deleted
+		Graph.bCacheDirty |= CachedPackages.Num() > 0;
+	}
+
+	/** Checks the given references of a package against the roots its mod may reference */
+	static void CheckDependencies(const FModGraph& Graph, const TSet<FString>& ModNames, FName PackageName, const TArray<FName>& Dependencies, bool bSoft, TArray<FModReferenceViolation>& OutViolations)
+	{
+		FString Root;
+		for (const FName& Dependency : Dependencies)
+		{
+			if (!FModManager::GetMountPointRoot(Dependency.ToString(), Root) || Graph.AllowedRoots.Contains(Root))
+			{
+				continue;
+			}
+
+			FModReferenceViolation& Violation = OutViolations.AddDefaulted_GetRef();
+			Violation.ModName = Graph.ModName;
+			Violation.Referencer = PackageName;
+			Violation.Dependency = Dependency;
+			Violation.bSoft = bSoft;
+			Violation.Reason = ModNames.Contains(Root)
+				? FString::Printf(TEXT("mod %s isn't required by %s"), *Root, *Graph.ModName)
+				: FString::Printf(TEXT("/%s/ isn't part of a packaged game"), *Root);
+		}
+	}
+
+	/** Checks every reference of a mod against the roots it may reference. Safe to call from any thread */
+	static void CheckReferences(FModGraph& Graph, const TSet<FString>& ModNames)
+	{
+		for (const TPair<FName, FPackage>& Pair : Graph.Packages)
+		{
+			CheckDependencies(Graph, ModNames, Pair.Key, Pair.Value.HardDependencies, false, Graph.Violations);
+			CheckDependencies(Graph, ModNames, Pair.Key, Pair.Value.SoftDependencies, true, Graph.SoftViolations);
+		}
+
+		auto SortViolations = [](const FModReferenceViolation& A, const FModReferenceViolation& B)
+		{
+			return A.Referencer != B.Referencer ? A.Referencer.LexicalLess(B.Referencer) : A.Dependency.LexicalLess(B.Dependency);
+		};
+		Graph.Violations.Sort(SortViolations);
+		Graph.SoftViolations.Sort(SortViolations);
+	}
+}
+
+int32 FModReferenceValidator::Run(const TArray<TSharedRef<IPlugin>>& Mods, TArray<FModReferenceViolation>& OutViolations)
+{
+	using namespace ModReferenceValidator;
+
+	OutViolations.Reset();
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Requirements are followed through every mod, including those that aren't validated
+	TArray<TSharedRef<IPlugin>> AllGameMods;
+	FModPackager::FindAvailableGameMods(AllGameMods);
+
+	TMap<FString, TArray<FString>> ModRequirements;
+	for (TSharedRef<IPlugin> Plugin : AllGameMods)
+	{
+		TArray<FString>& Requirements = ModRequirements.Add(Plugin->GetName());
+		for (const FPluginReferenceDescriptor& Reference : Plugin->GetDescriptor().Plugins)
+		{
+			if (Reference.bEnabled)
+			{
+				Requirements.Add(Reference.Name);
+			}
+		}
+	}
+
+	TSet<FString> ModNames;
+	for (const TPair<FString, TArray<FString>>& Pair : ModRequirements)
+	{
+		ModNames.Add(Pair.Key);
+	}
+
+	// Content that is part of every packaged game, whichever mods are installed
+	TSet<FString> BaseRoots = { TEXT("Engine"), TEXT("Game"), TEXT("Script") };
+	for (TSharedRef<IPlugin> Plugin : IPluginManager::Get().GetEnabledPluginsWithContent())
+	{
+		if (!ModNames.Contains(Plugin->GetName()))
+		{
+			BaseRoots.Add(Plugin->GetName());
+		}
+	}
+
+	TArray<FModGraph> Graphs;
+	Graphs.Reserve(Mods.Num());
+
+	for (TSharedRef<IPlugin> Plugin : Mods)
+	{
+		FModGraph& Graph = Graphs.AddDefaulted_GetRef();
+		Graph.ModName = Plugin->GetName();
+		Graph.ContentDir = FPaths::ConvertRelativePathToFull(Plugin->GetContentDir()) / TEXT("");
+		Graph.MountedAssetPath = Plugin->GetMountedAssetPath();
+
+		// The runtime mounts the requirements of a mod before it, and theirs before them
+		Graph.AllowedRoots = BaseRoots;
+		TArray<FString> PendingMods = { Graph.ModName };
+		while (PendingMods.Num() > 0)
+		{
+			const FString ModName = PendingMods.Pop(false);
+
+			bool bAlreadyAllowed = false;
+			Graph.AllowedRoots.Add(ModName, &bAlreadyAllowed);
+
+			if (!bAlreadyAllowed)
+			{
+				if (const TArray<FString>* Requirements = ModRequirements.Find(ModName))
+				{
+					PendingMods.Append(*Requirements);
+				}
+			}
+		}
+
+		LoadCache(Graph);
+	}
+
+	ParallelFor(Graphs.Num(), [&Graphs](int32 Index)
+	{
+		ScanPackages(Graphs[Index]);
+	});
+
+	// The asset registry only answers on the game thread, and is only asked about the packages that changed
+	TArray<FString> ChangedFilenames;
+	for (const FModGraph& Graph : Graphs)
+	{
+		for (const FName& PackageName : Graph.ChangedPackages)
+		{
+			ChangedFilenames.Add(Graph.Packages[PackageName].Filename);
+		}
+	}
+
+	if (ChangedFilenames.Num() > 0)
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+		AssetRegistry.ScanFilesSynchronous(ChangedFilenames, true);
+
+		for (FModGraph& Graph : Graphs)
+		{
+			for (const FName& PackageName : Graph.ChangedPackages)
+			{
+				// A hard reference fails to load without its dependency, a soft one only once it is resolved
+				FPackage& Package = Graph.Packages[PackageName];
+				Package.HardDependencies.Reset();
+				Package.SoftDependencies.Reset();
+				AssetRegistry.GetDependencies(PackageName, Package.HardDependencies, EAssetRegistryDependencyType::Hard);
+				AssetRegistry.GetDependencies(PackageName, Package.SoftDependencies, EAssetRegistryDependencyType::Soft);
+			}
+		}
+	}
+
+	ParallelFor(Graphs.Num(), [&Graphs, &ModNames](int32 Index)
+	{
+		CheckReferences(Graphs[Index], ModNames);
+	});
+
+	TArray<TSharedPtr<FJsonValue>> ViolationValues;
+	int32 NumPackages = 0;
+	int32 NumSoftViolations = 0;
+
+	for (FModGraph& Graph : Graphs)
+	{
+		if (Graph.bCacheDirty)
+		{
+			SaveCache(Graph);
+		}
+
+		NumPackages += Graph.Packages.Num();
+
+		for (const FModReferenceViolation& Violation : Graph.Violations)
+		{
+			UE_LOG(LogModSupportEditor, Error, TEXT("%s references %s, but %s"), *Violation.Referencer.ToString(), *Violation.Dependency.ToString(), *Violation.Reason);
+		}
+
+		for (const FModReferenceViolation& Violation : Graph.SoftViolations)
+		{
+			UE_LOG(LogModSupportEditor, Warning, TEXT("%s soft references %s, but %s"), *Violation.Referencer.ToString(), *Violation.Dependency.ToString(), *Violation.Reason);
+		}
+
+		for (const TArray<FModReferenceViolation>* Violations : { &Graph.Violations, &Graph.SoftViolations })
+		{
+			for (const FModReferenceViolation& Violation : *Violations)
+			{
+				TSharedRef<FJsonObject> ViolationObject = MakeShared<FJsonObject>();
+				ViolationObject->SetStringField(TEXT("mod"), Violation.ModName);
+				ViolationObject->SetStringField(TEXT("referencer"), Violation.Referencer.ToString());
+				ViolationObject->SetStringField(TEXT("dependency"), Violation.Dependency.ToString());
+				ViolationObject->SetBoolField(TEXT("soft"), Violation.bSoft);
+				ViolationObject->SetStringField(TEXT("reason"), Violation.Reason);
+				ViolationValues.Add(MakeShared<FJsonValueObject>(ViolationObject));
+			}
+		}
+
+		NumSoftViolations += Graph.SoftViolations.Num();
+		OutViolations.Append(MoveTemp(Graph.Violations));
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetArrayField(TEXT("violations"), ViolationValues);
+
+	const FString ReportFilename = FPaths::ProjectSavedDir() / TEXT("ModInfo") / TEXT("ModReferenceViolations.json");
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *ReportFilename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to write %s"), *ReportFilename);
+	}
+
+	UE_LOG(LogModSupportEditor, Display, TEXT("Validated the references of %d package(s) in %d mod(s) in %.2f s, %d package(s) were rescanned and %d hard and %d soft reference(s) leave the allowed content"),
+		NumPackages, Mods.Num(), FPlatformTime::Seconds() - StartTime, ChangedFilenames.Num(), OutViolations.Num(), NumSoftViolations);
+
+	return OutViolations.Num();
+}
+
+FString FModReferenceValidator::GetCacheFilename(const FString& ModName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TEXT("ReferenceGraph.bin");
+}
@@ -0,0 +1,191 @@
+#include "ModReleaseManifest.h"
+
+#include "ModSupportEditorLog.h"
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+FModReleaseManifest::FModReleaseManifest()
+	: PatchCount(0)
+{
+}
+
+FString FModReleaseManifest::GetManifestFilename(const FString& ModName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("ModInfo") / ModName / TEXT("ModRelease.json");
+}
+
+void FModReleaseManifest::Build(TSharedRef<IPlugin> Plugin)
+{
+	Assets.Reset();
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	FString MountedAssetPath = Plugin->GetMountedAssetPath();
+	MountedAssetPath.RemoveFromEnd(TEXT("/"));
+
+	TArray<FAssetData> AssetDataList;
+	AssetRegistry.GetAssetsByPath(FName(*MountedAssetPath), AssetDataList, true);
+
+	TArray<FName> PackageNames;
+	for (const FAssetData& AssetData : AssetDataList)
+	{
+		PackageNames.AddUnique(AssetData.PackageName);
+	}
+
+	TArray<FModAssetRecord> Records;
+	Records.SetNum(PackageNames.Num());
+
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		AssetRegistry.GetDependencies(PackageNames[Index], Records[Index].Dependencies);
+	}
+
+	// Hashing reads every package of the mod, which is by far the most expensive part
+	ParallelFor(PackageNames.Num(), [&PackageNames, &Records](int32 Index)
+	{
+		FString PackageFilename;
+		if (FPackageName::DoesPackageExist(PackageNames[Index].ToString(), nullptr, &PackageFilename))
+		{
+			Records[Index].Hash = LexToString(FMD5Hash::HashFile(*PackageFilename));
+		}
+	});
+
+	for (int32 Index = 0; Index < PackageNames.Num(); ++Index)
+	{
+		Assets.Add(PackageNames[Index], MoveTemp(Records[Index]));
+	}
+}
+
+bool FModReleaseManifest::Load(const FString& Filename)
+{
+	Assets.Reset();
+	PatchCount = 0;
+
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *Filename))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, RootObject) || !RootObject.IsValid())
+	{
+		UE_LOG(LogModSupportEditor, Warning, TEXT("Failed to parse release manifest %s"), *Filename);
+		return false;
+	}
+
+	PatchCount = RootObject->GetIntegerField(TEXT("patchCount"));
+
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : RootObject->GetObjectField(TEXT("assets"))->Values)
+	{
+		const TSharedPtr<FJsonObject>& AssetObject = Pair.Value->AsObject();
+
+		FModAssetRecord& Record = Assets.Add(FName(*Pair.Key));
+		Record.Hash = AssetObject->GetStringField(TEXT("hash"));
+
+		for (const TSharedPtr<FJsonValue>& Dependency : AssetObject->GetArrayField(TEXT("dependencies")))
+		{
+			Record.Dependencies.Add(FName(*Dependency->AsString()));
+		}
+	}
+
+	return true;
+}
+
+bool FModReleaseManifest::Save(const FString& Filename) const
+{
+	TSharedRef<FJsonObject> AssetsObject = MakeShared<FJsonObject>();
+
+	for (const TPair<FName, FModAssetRecord>& Pair : Assets)
+	{
+		TArray<TSharedPtr<FJsonValue>> Dependencies;
+		for (const FName& Dependency : Pair.Value.Dependencies)
+		{
+			Dependencies.Add(MakeShared<FJsonValueString>(Dependency.ToString()));
+		}
+
+		TSharedRef<FJsonObject> AssetObject = MakeShared<FJsonObject>();
+		AssetObject->SetStringField(TEXT("hash"), Pair.Value.Hash);
+		AssetObject->SetArrayField(TEXT("dependencies"), Dependencies);
+
+		AssetsObject->SetObjectField(Pair.Key.ToString(), AssetObject);
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetNumberField(TEXT("patchCount"), PatchCount);
+	RootObject->SetObjectField(TEXT("assets"), AssetsObject);
+
+	FString JsonString;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+	if (!FJsonSerializer::Serialize(RootObject, Writer) || !FFileHelper::SaveStringToFile(JsonString, *Filename))
+	{
+		UE_LOG(LogModSupportEditor, Error, TEXT("Failed to save release manifest %s"), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+bool FModReleaseManifest::GetChangedPackages(const FModReleaseManifest& Previous, TArray<FName>& OutChangedPackages) const
+{
+	OutChangedPackages.Reset();
+
+	for (const TPair<FName, FModAssetRecord>& Pair : Previous.Assets)
+	{
+		if (!Assets.Contains(Pair.Key))
+		{
+			// A patch pak can override packages of an older pak, but never remove them
+			return false;
+		}
+	}
+
+	TSet<FName> ChangedPackages;
+	for (const TPair<FName, FModAssetRecord>& Pair : Assets)
+	{
+		const FModAssetRecord* PreviousRecord = Previous.Assets.Find(Pair.Key);
+		if (PreviousRecord == nullptr || PreviousRecord->Hash != Pair.Value.Hash)
+		{
+			ChangedPackages.Add(Pair.Key);
+		}
+	}
+
+	// Cooked packages embed data of their dependencies, so dependers of changed packages are changed as well
+	TMap<FName, TArray<FName>> Referencers;
+	for (const TPair<FName, FModAssetRecord>& Pair : Assets)
+	{
+		for (const FName& Dependency : Pair.Value.Dependencies)
+		{
+			Referencers.FindOrAdd(Dependency).Add(Pair.Key);
+		}
+	}
+
+	TArray<FName> Queue = ChangedPackages.Array();
+	while (Queue.Num() > 0)
+	{
+		const FName PackageName = Queue.Pop(false);
+
+		if (const TArray<FName>* PackageReferencers = Referencers.Find(PackageName))
+		{
+			for (const FName& Referencer : *PackageReferencers)
+			{
+				bool bAlreadyChanged = false;
+				ChangedPackages.Add(Referencer, &bAlreadyChanged);
+				if (!bAlreadyChanged)
+				{
+					Queue.Add(Referencer);
+				}
+			}
+		}
+	}
+
+	OutChangedPackages = ChangedPackages.Array();
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ModBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures how mod discovery, descriptor parsing, mounting and the first asset load scale with the number of installed
+ * mods, on synthetic mod farms generated by FModFarmGenerator. Every farm mod ships its assets in a pak, so mounting
+ * includes pak mounting and the first asset is read from a pak. Every farm discovers its mods through a manifest cache
+ * of its own.
+ *
+ * Usage: UE4Editor-Cmd.exe Project.uproject -run=ModBenchmark [-Scales=10+100+1000+5000] [-AssetsPerMod=N] [-AssetSize=Bytes]
+ *
+ * The results are logged and written to Saved/ModInfo/ModBenchmark.json.
+ */
+UCLASS()
+class UModBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UModBenchmarkCommandlet();
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Packages of a mod that are packaged into the same pak */
+struct FModPackageChunk
+{
+	FString Name;
+
+	TArray<FName> Packages;
+
+	/** Size of the packages on disk, in bytes */
+	int64 Size = 0;
+};
+
+/**
+ * Splits a large mod into a core chunk that is always mounted and optional chunks that the runtime mounts on the
+ * first load of one of their packages.
+ */
+class FModChunker
+{
+public:
+
+	/** Name of the chunk that is always mounted */
+	static const TCHAR* CoreChunkName;
+
+	/**
+	 * Clusters the packages of a mod by their hard references within the mod, so a package and everything it imports
+	 * always end up in the same chunk. Clusters with a package the load order recorder saw being loaded go to the core,
+	 * or clusters with a map if no load order was recorded. The remaining clusters are packed into optional chunks
+	 * of about UModPackagingSettings::TargetChunkSizeMB each.
+	 *
+	 * @param	Plugin		The mod to split
+	 * @param	OutChunks	Receives the core chunk followed by the optional chunks
+	 * @return	False if the mod is too small to be split or has nothing to put into an optional chunk
+	 */
+	static bool SplitMod(TSharedRef<class IPlugin> Plugin, TArray<FModPackageChunk>& OutChunks);
+};
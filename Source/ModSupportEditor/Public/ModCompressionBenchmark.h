@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ModPackagingSettings.h"
+
+/** The outcome of compressing the sample of a mod with one compression profile */
+struct FModCompressionBenchmarkResult
+{
+	FModCompressionProfile Profile;
+
+	/** Size of the sample before compression */
+	int64 UncompressedSize = 0;
+
+	/** Size of the sample after compression, with every file padded to the pak alignment */
+	int64 CompressedSize = 0;
+
+	double CompressSeconds = 0.0;
+
+	/** Time spent reading back every block, decompressing the compressed blocks and copying the stored ones */
+	double DecompressSeconds = 0.0;
+
+	/** @return Megabytes of the sample read back per second */
+	double GetDecompressionThroughput() const;
+};
+
+/**
+ * Compresses a sample of a mod's cooked assets block by block the way UnrealPak does, with every candidate
+ * compression format and block size, to compare pak size against decompression throughput.
+ */
+class FModCompressionBenchmark
+{
+public:
+
+	/**
+	 * Runs the benchmark on a mod with the candidates of UModPackagingSettings
+	 *
+	 * @param	Plugin			The mod to benchmark
+	 * @param	TargetPlatform	The cooked platform to sample assets from, e.g. WindowsNoEditor
+	 * @param	OutResults		Receives one result for every candidate
+	 * @return	False if the mod has no assets to sample
+	 */
+	static bool Run(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatform, TArray<FModCompressionBenchmarkResult>& OutResults);
+
+	/** Logs the results and writes them to Saved/ModInfo/<ModName>/CompressionBenchmark.json */
+	static void WriteReport(const FString& ModName, const TArray<FModCompressionBenchmarkResult>& Results);
+
+private:
+
+	/**
+	 * Reads the files to compress, preferring cooked assets and falling back to the editor packages. Files are picked
+	 * in a random order with a fixed seed, so the sample covers the whole mod and is the same on every run.
+	 */
+	static void GatherSample(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatform, int64 MaxSampleSize, TArray<TArray<uint8>>& OutFiles);
+
+	static FModCompressionBenchmarkResult Measure(const FModCompressionProfile& Profile, const TArray<TArray<uint8>>& Files);
+};
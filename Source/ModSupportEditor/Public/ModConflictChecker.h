@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Finds package files that several packaged mods ship at the same path, where the mod mounted with precedence
+ * silently overrides the others. Only the paks of the current release of each mod are checked, as listed by the pak
+ * manifest of its last release, and the mods are ordered like the runtime mounts them, see FModDependencyResolver.
+ * The package files of each mod are cached per mod and only read again from its paks once those changed, so checking
+ * after packaging a single mod doesn't rescan all of them.
+ */
+class FModConflictChecker
+{
+public:
+
+	/**
+	 * Indexes the paks every mod was packaged to, logs every conflict and writes them to Saved/ModInfo/ModConflicts.json
+	 *
+	 * @param	Mods				The mods to check against each other
+	 * @param	OutputDirectory		Directory the mods were packaged to by the ModPackage commandlet
+	 * @param	TargetPlatform		Platform whose paks are checked. Every platform is cooked from the same content, so they ship the same package files
+	 * @return	The number of package files shipped by more than one mod
+	 */
+	static int32 Run(const TArray<TSharedRef<class IPlugin>>& Mods, const FString& OutputDirectory, const FString& TargetPlatform);
+
+private:
+
+	/** Gets the paks of the current release of a mod for a platform, leaving out paks of earlier releases that are still in the output directory */
+	static void GetReleasePakFiles(const FString& ModName, const FString& OutputDirectory, const FString& TargetPlatform, TArray<FString>& OutPakFiles);
+
+	/** Gets the package files in the paks of a mod, from its cache if the paks didn't change since */
+	static void GetPackageFilenames(const FString& ModName, const TArray<FString>& PakFiles, TArray<FName>& OutFilenames);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Finds cooked packages of a mod that are byte-identical to a package of a mod it requires, e.g. materials and
+ * textures a mod copied from the base mod it builds on. The mod is then packaged without them, and the runtime
+ * redirects them to the packages of the required mod, which is mounted before it, see FModSharedContentMap.
+ * The packages redirected to stay at their original path in their own mod, so nothing is renamed after cooking.
+ */
+class FModDeduplicator
+{
+public:
+
+	/**
+	 * Hashes the cooked packages of the given mods and redirects every package that a mod it requires ships
+	 * byte-identical, then saves the map of the redirected packages. Works on the content cooked by the last package
+	 * of each mod, so mods have to be packaged once before their duplicates are found.
+	 *
+	 * @param	Mods				The mods to deduplicate, their requirements are followed through all of them
+	 * @param	OutChangedMods		Receives the mods whose redirected packages changed, which need a full package
+	 * @return	True if the map was saved
+	 */
+	static bool Run(const TArray<TSharedRef<class IPlugin>>& Mods, TArray<FString>& OutChangedMods);
+
+	/** Gets the redirects of a mod saved by the last run, which ship next to its paks */
+	static void GetSharedContentMap(const FString& ModName, class FModSharedContentMap& OutMap);
+
+	/** Gets the packages of a mod that the last run redirected to a required mod */
+	static void GetSharedPackages(const FString& ModName, TArray<FName>& OutPackages);
+
+	/** @return The filename of the map of all mods saved by the last run */
+	static FString GetSharedContentMapFilename();
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPackage;
+
+/**
+ * Keeps track of the unsaved packages of every mod by listening to package dirty and save events,
+ * so checking a mod for unsaved content doesn't have to go through every dirty package of the editor.
+ */
+class FModDirtyPackageTracker
+{
+public:
+
+	FModDirtyPackageTracker();
+	~FModDirtyPackageTracker();
+
+	/**
+	 * Checks if any package under a mount point has unsaved changes, and forgets the packages that were deleted or
+	 * garbage collected on the way
+	 *
+	 * @param	MountedAssetPath	The mount point of the mod, e.g. /MyMod/
+	 * @return	True if the mod has unsaved content
+	 */
+	bool HasDirtyPackages(const FString& MountedAssetPath);
+
+private:
+
+	void HandlePackageDirtyStateChanged(UPackage* Package);
+	void HandlePackageSaved(const FString& PackageFilename, UObject* Outer);
+
+	/** Adds or removes the package from the dirty packages of its mount point */
+	void UpdatePackage(UPackage* Package);
+
+private:
+
+	/** The dirty packages of every mount point, indexed by the root of the mount point */
+	TMap<FName, TSet<FName>> DirtyPackages;
+
+	FDelegateHandle PackageDirtyStateChangedHandle;
+	FDelegateHandle PackageSavedHandle;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Describes a farm of synthetic content mods */
+struct FModFarmSettings
+{
+	/** Directory the mods are generated in, one sub directory per mod */
+	FString OutputDir;
+
+	/** Prefix of the generated mod names. Mods are named <Prefix>_<Index> */
+	FString NamePrefix = TEXT("ModFarm");
+
+	int32 NumMods = 10;
+
+	/** Number of texture assets in every mod */
+	int32 AssetsPerMod = 4;
+
+	/** Approximate size in bytes of every asset */
+	int32 AssetSize = 64 * 1024;
+
+	/** Pak the assets of every mod into Content/Paks/<Platform> with a pak manifest, the way packaged mods ship, instead of leaving them loose */
+	bool bPakContent = true;
+};
+
+/**
+ * Generates synthetic content mods from the BaseTemplate, for measuring how discovery, mounting
+ * and loading scale with the number of installed mods.
+ */
+class FModFarmGenerator
+{
+public:
+
+	/**
+	 * Generates the mods of a farm. Mods that already exist are left untouched, so a farm can be grown, unless they
+	 * are missing the pak the settings ask for.
+	 *
+	 * @return	True if every mod was generated
+	 */
+	static bool Generate(const FModFarmSettings& Settings);
+
+	/** @return The name of a generated mod */
+	static FString GetModName(const FModFarmSettings& Settings, int32 ModIndex);
+
+	/** @return The object path of an asset in a generated mod */
+	static FString GetAssetPath(const FModFarmSettings& Settings, int32 ModIndex, int32 AssetIndex);
+
+	/** @return The directory the assets every mod gets a copy of are saved to */
+	static FString GetTemplateDir(const FModFarmSettings& Settings);
+
+private:
+
+	/** Paks the assets of a generated mod and removes the loose copies, so they can only be loaded from the pak */
+	static bool PakModContent(const FModFarmSettings& Settings, const FString& ModDir, const FString& PakFilename);
+
+	/** Saves the assets every mod gets a copy of, so they only have to be created once per farm */
+	static bool CreateTemplateAssets(const FModFarmSettings& Settings, const FString& TemplateContentDir);
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ModPackageCommandlet.generated.h"
+
+/**
+ * Packages game mods without any UI, running several HotPatcher jobs at once.
+ *
+ * Usage: UE4Editor-Cmd.exe Project.uproject -run=ModPackage -OutputDir=<Dir> [-Mods=ModA+ModB] [-Platforms=WindowsNoEditor+LinuxServer] [-MaxJobs=N] [-Full] [-Deduplicate] [-CheckConflicts] [-DeltaFrom=<Dir>] [-ValidateReferences] [-ValidateOnly]
+ *
+ * Every mod is packaged for the platforms given by -Platforms, or else for UModPackagingSettings::TargetPlatforms.
+ * Each platform of a mod is cooked and paked by a job of its own, so the platforms of a mod are cooked concurrently.
+ * A platform fails if its job didn't write cooked content of the mod to Saved/Cooked/<Platform>.
+ *
+ * Unless -Full is given, mods that were packaged before only get a patch pak holding the packages that changed
+ * since their last release, see FModReleaseManifest.
+ *
+ * With -Deduplicate the cooked content of all mods is searched for packages a mod ships byte-identical to a mod it
+ * requires first, which are left out of the mod and loaded from the required mod, see FModDeduplicator. Mods whose
+ * deduplicated packages changed are packaged completely, even if -Mods leaves them out.
+ *
+ * With -CheckConflicts the paks of the current release of all mods in the output directory are checked for package
+ * files that several mods ship once packaging finished, for the first platform, see FModConflictChecker.
+ *
+ * With -DeltaFrom every pak that the release packaged to the given output directory shipped as well gets a binary
+ * delta written next to it, which the runtime applies to the installed pak, see FModPakDelta.
+ *
+ * With -ValidateReferences the references of every selected mod are validated first, and mods referencing content
+ * they can't rely on at runtime fail instead of being packaged, see FModReferenceValidator. With -ValidateOnly the
+ * mods are only validated, and no -OutputDir is needed.
+ *
+ * With -BenchmarkCompression nothing is packaged. Instead the cooked assets of every selected mod are compressed
+ * with each candidate of UModPackagingSettings, and pak size and decompression throughput are reported per mod.
+ */
+UCLASS()
+class UModPackageCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UModPackageCommandlet();
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+};
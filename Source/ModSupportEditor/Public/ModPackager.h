@@ -4,6 +4,19 @@
 
 #include "CoreMinimal.h"
 
+/** Options applied on top of the packaging template */
+struct FModPackageOptions
+{
+	/** If not empty, only these packages are cooked and written to a patch pak layered over the previous release */
+	TArray<FName> IncrementalPackages;
+
+	/** Index of the incremental patch, used to give its pak a unique name */
+	int32 PatchIndex = 0;
+
+	/** Cooked platforms to package for, e.g. WindowsNoEditor. If empty, UModPackagingSettings::TargetPlatforms is used */
+	TArray<FString> TargetPlatforms;
+};
+
 struct FModSupportCommand
 {
 	TSharedPtr<class IPlugin> PluginInfo;
@@ -18,8 +31,108 @@ public:
 
 	void OpenPluginPackager(TSharedRef<class IPlugin> Plugin);
 
+	/** Queues packaging a mod in a background process, see FModPackagingQueue */
 	void PackagePlugin(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory);
 
+	/**
+	 * Writes the HotPatcher configurations that package a mod to Saved/ModInfo/<ModName>/<Platform>/, one for every
+	 * target platform. What doesn't depend on the cooked platform, like chunking, the load order and the asset
+	 * registry, is worked out once for all of them, and every configuration cooks a single platform so they can run
+	 * next to each other.
+	 *
+	 * @param	Plugin				The mod to package
+	 * @param	OutputDirectory		Directory the packaged mod will be written to
+	 * @param	Options				Options applied on top of the packaging template
+	 * @param	OutConfigFilenames	Receives the filenames of the written configurations, in the order of GetTargetPlatforms
+	 * @return	True if every configuration was written
+	 */
+	static bool WritePackageConfig(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, TArray<FString>& OutConfigFilenames);
+
+	/**
+	 * Turns the load order recorded for a mod at runtime into an UnrealPak order file, which lays out the files of
+	 * the mod's pak in the order they are read.
+	 *
+	 * @param	Plugin				The mod to write the order file for
+	 * @param	OutOrderFilename	Receives the filename of the written order file
+	 * @return	False if no load order was recorded for the mod or the order file couldn't be written
+	 */
+	static bool WritePakOrderFile(TSharedRef<class IPlugin> Plugin, FString& OutOrderFilename);
+
+	/** Writes the chunk map the runtime uses to mount the optional chunks of a split mod next to its paks for every platform, or removes it if the mod isn't split */
+	static bool WriteChunkMap(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const TArray<struct FModPackageChunk>& Chunks, const TArray<FString>& TargetPlatforms);
+
+	/** Writes the packages the deduplicator redirected to a required mod next to the paks of a mod for every platform, or removes them if it has none */
+	static bool WriteSharedContentMap(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, const TArray<FString>& TargetPlatforms);
+
+	/**
+	 * Writes the asset registry entries of the content of a mod next to its paks, where the runtime merges them into
+	 * the global asset registry instead of scanning the mod. Always covers the whole mod, so a patch replaces it.
+	 */
+	static bool WriteAssetRegistry(TSharedRef<class IPlugin> Plugin, const FString& OutputDirectory, const FModPackageOptions& Options, const TArray<FString>& TargetPlatforms);
+
+	/** @return The HotPatcher version a package of a mod is written as, which names its output directory and paks */
+	static FString GetVersionId(const FString& ModName, const FModPackageOptions& Options);
+
+	/**
+	 * Hashes the paks written by a package of a mod for one platform and writes the pak manifest the runtime verifies
+	 * them against next to them. The manifest of a patch also lists the paks of the releases it is layered over. The
+	 * manifest of a full package only lists its own paks, so the runtime skips the patch paks of earlier releases.
+	 */
+	static bool WritePakManifest(const FString& ModName, const FString& OutputDirectory, const FModPackageOptions& Options, const FString& TargetPlatform);
+
+	/**
+	 * Writes a delta for every pak of a package of a mod that an earlier release of the mod shipped as well, so
+	 * players only download what changed. Each delta is written next to the pak it updates, see FModPakDelta.
+	 *
+	 * @param	ModName					The packaged mod
+	 * @param	OutputDirectory			Directory the mod was packaged to
+	 * @param	PreviousOutputDirectory	Directory the earlier release of the mod was packaged to
+	 * @param	Options					Options the mod was packaged with
+	 * @param	TargetPlatform			The platform whose paks get deltas
+	 */
+	static bool WritePakDeltas(const FString& ModName, const FString& OutputDirectory, const FString& PreviousOutputDirectory, const FModPackageOptions& Options, const FString& TargetPlatform);
+
+	/** @return The directory the cooked content of a mod is written to for the given platform */
+	static FString GetCookedContentDir(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatform);
+
+	/**
+	 * Makes the configuration cook the shaders of a mod into a shared shader library named after the mod and stage the
+	 * library into the mod's content directory, where the runtime opens it when the mod is mounted.
+	 */
+	static void AddShaderLibrary(TSharedRef<class IPlugin> Plugin, const FString& TargetPlatform, const TSharedRef<class FJsonObject>& ConfigObject);
+
+	/**
+	 * Checks that the run packaging a mod for a platform cooked the mod. The cooked content directory keeps the content
+	 * of earlier cooks, so only files written since the run started count.
+	 *
+	 * @param	StartTime	UTC time the run was started at
+	 * @return	False if the run left no cooked content of the mod for that platform
+	 */
+	static bool VerifyCookedContent(const FString& ModName, const FString& TargetPlatform, const FDateTime& StartTime);
+
+	/**
+	 * Checks that the cook of a mod for a platform wrote every shader library AddShaderLibrary stages. The libraries are
+	 * written by the same HotPatcher run that paks them, so they can only be checked once the run finished.
+	 *
+	 * @return	False if shader libraries are packaged and one of them is missing
+	 */
+	static bool VerifyShaderLibrary(const FString& ModName, const FString& TargetPlatform);
+
+	/** Gets the UnrealPak options that compress the paks of a mod with its compression profile */
+	static void GetCompressionOptions(const FString& ModName, TArray<FString>& OutOptions);
+
+	/** Gets the cooked platforms a package of a mod is made for, falling back to the settings and then to the host platform */
+	static void GetTargetPlatforms(const FModPackageOptions& Options, TArray<FString>& OutTargetPlatforms);
+
+	/** @return The cooked platform mods are packaged for if no target platforms are set, matching the platform the editor runs on */
+	static FString GetHostTargetPlatform();
+
+	/** @return The arguments that make an editor process package a mod with the given HotPatcher configuration */
+	static FString GetPackageCommandLine(const FString& ConfigFilename);
+
+	/** Gets all available game mod plugin packages  */
+	static void FindAvailableGameMods(TArray<TSharedRef<class IPlugin>>& OutAvailableGameMods);
+
 	/** Generates submenu content for the plugin packager command */
 	void GeneratePackagerMenuContent(class FMenuBuilder& MenuBuilder);
 
@@ -27,14 +140,23 @@ public:
 	TSharedRef<class SWidget> GeneratePackagerComboButtonContent();
 
 private:
-	/** Gets all available game mod plugin packages  */
-	void FindAvailableGameMods(TArray<TSharedRef<class IPlugin>>& OutAvailableGameMods);
+	/** Rebuilds the cached list of game mods, their commands and actions if plugins or the mods directory changed since */
+	void UpdateAvailableGameMods();
+
+	/** Invalidates the cached game mods when a plugin was created or mounted */
+	void HandleNewPlugin(class IPlugin& Plugin);
+
+	/** Invalidates the cached game mods when a mod descriptor under the mods directory changed */
+	void HandleModsDirectoryChanged(const TArray<struct FFileChangeData>& FileChanges);
 
 	/** Gets all available game mod plugins and registers command info for them */
 	void GetAvailableModCommands(const TArray<TSharedRef<class IPlugin>>& AvailableMod);
 
-	/** Generates menu content for the supplied set of commands */
-	void GeneratePackagerMenuContent_Internal(class FMenuBuilder& MenuBuilder, const TArray<TSharedPtr<FUICommandInfo>>& Commands);
+	/** Generates menu content for the supplied set of commands, one for each of the supplied mods */
+	void GeneratePackagerMenuContent_Internal(class FMenuBuilder& MenuBuilder, const TArray<TSharedPtr<FUICommandInfo>>& Commands, const TArray<TSharedRef<class IPlugin>>& Mods);
+
+	/** Gets the menu label of a mod, which tells if the mod has unsaved content */
+	FText GetModMenuLabel(TSharedRef<class IPlugin> Mod) const;
 
 	/**
 	* Checks if a plugin has any unsaved content
@@ -42,8 +164,26 @@ private:
 	* @param	Plugin			The plugin to check for unsaved content
 	* @return	True if all mod content has been saved, false otherwise
 	*/
-	bool IsAllContentSaved(TSharedRef<class IPlugin> Plugin);
+	bool IsAllContentSaved(TSharedRef<class IPlugin> Plugin) const;
 
 private:
 	TArray<TSharedPtr<class FUICommandInfo>> ModCommands;
+
+	/** The cached game mods, in the same order as their commands */
+	TArray<TSharedRef<class IPlugin>> AvailableGameMods;
+
+	/** Maps every mod command to packaging its mod */
+	TSharedPtr<class FUICommandList> GameModActionsList;
+
+	/** True if the cached game mods have to be rebuilt before they are used */
+	bool bGameModsDirty;
+
+	FString ModsDirectory;
+	FDelegateHandle ModsDirectoryWatcherHandle;
+
+	/** Packages the mods shared from the editor in the background */
+	TSharedRef<class FModPackagingQueue> PackagingQueue;
+
+	/** Tracks the unsaved packages of every mod */
+	TUniquePtr<class FModDirtyPackageTracker> DirtyPackageTracker;
 };
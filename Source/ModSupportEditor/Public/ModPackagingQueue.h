@@ -0,0 +1,88 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "ModPackager.h"
+
+class FMonitoredProcess;
+class SNotificationItem;
+
+/**
+ * Packages mods in background editor processes, one mod after the other, so the editor stays responsive while a mod
+ * is cooked and packed. The platforms of a mod are packaged by concurrent processes, each cooking the mod for its
+ * platform before paking it, and a platform fails if its process wrote no cooked content. Every queued mod gets a
+ * notification that streams the output of its processes and can cancel them.
+ */
+class FModPackagingQueue : public TSharedFromThis<FModPackagingQueue>
+{
+public:
+
+	~FModPackagingQueue();
+
+	/**
+	 * Queues packaging a mod with the given HotPatcher configurations, and starts it right away if nothing else is packaging
+	 *
+	 * @param	ModName				The mod to package
+	 * @param	Options				Options the configurations were written with, which list the target platforms
+	 * @param	ConfigFilenames		HotPatcher configurations written by FModPackager::WritePackageConfig, one per target platform
+	 * @param	OutputDirectory		Directory the configurations package the mod to
+	 * @return	False if the mod is queued already
+	 */
+	bool Enqueue(const FString& ModName, const FModPackageOptions& Options, const TArray<FString>& ConfigFilenames, const FString& OutputDirectory);
+
+	/** @return True if the mod is being packaged or waiting to be */
+	bool IsQueued(const FString& ModName) const;
+
+	/** Stops packaging the mod, or takes it out of the queue if it wasn't started yet */
+	void Cancel(const FString& ModName);
+
+private:
+
+	/** Packaging of a mod for one platform, a single process cooks the mod for the platform and paks it */
+	struct FPlatformCook
+	{
+		FString TargetPlatform;
+		FString ConfigFilename;
+		TSharedPtr<FMonitoredProcess> Process;
+
+		/** UTC time the process was launched, content cooked before it is left over from earlier runs */
+		FDateTime LaunchTime;
+
+		bool bFinished = false;
+		bool bSucceeded = false;
+	};
+
+	struct FJob
+	{
+		FString ModName;
+		FModPackageOptions Options;
+		FString OutputDirectory;
+		TArray<FPlatformCook> Cooks;
+
+		bool bStarted = false;
+		bool bCanceled = false;
+
+		TSharedPtr<SNotificationItem> Notification;
+
+		/** Last line any of the processes wrote. Written by the threads monitoring the processes */
+		FString LastOutput;
+		FCriticalSection OutputCritical;
+
+		double StartTime = 0.0;
+	};
+
+	/** Starts the first queued job if no job is running */
+	void StartNextJob();
+
+	/** Finishes the cook of a job for one platform, and the job once all of its cooks finished. Game thread only */
+	void HandleCookCompleted(TSharedRef<FJob> Job, int32 CookIndex, int32 ReturnCode);
+
+	/** Finishes the running job and starts the next one. Game thread only */
+	void HandleJobCompleted(TSharedRef<FJob> Job);
+
+	/** @return The progress shown in the notification of a job */
+	FText GetJobText(TWeakPtr<FJob> WeakJob) const;
+
+	/** Queued jobs, the first one is running once it has a process */
+	TArray<TSharedRef<FJob>> Jobs;
+};
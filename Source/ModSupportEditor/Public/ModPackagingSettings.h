@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "ModPackagingSettings.generated.h"
+
+/** How the paks of a mod are compressed and laid out */
+USTRUCT()
+struct FModCompressionProfile
+{
+	GENERATED_BODY()
+
+	/** Compression format passed to UnrealPak, e.g. Zlib, Gzip, LZ4 or a format provided by a compression plugin */
+	UPROPERTY(EditAnywhere, Category = "Compression")
+	FName CompressionFormat = TEXT("Zlib");
+
+	/** Size of the blocks files are compressed in. Bigger blocks compress better, smaller blocks waste less on partial reads */
+	UPROPERTY(EditAnywhere, Category = "Compression", meta = (ClampMin = "4096"))
+	int32 CompressionBlockSize = 64 * 1024;
+
+	/** Every file in the pak starts at a multiple of this many bytes, padding the file before it. 0 packs the files without padding */
+	UPROPERTY(EditAnywhere, Category = "Compression", meta = (ClampMin = "0"))
+	int32 PakAlignment = 0;
+};
+
+UCLASS(config = Editor, defaultconfig, meta = (DisplayName = "Mod Packaging"))
+class UModPackagingSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	UModPackagingSettings();
+
+	/** @return The compression profile used to package the named mod */
+	const FModCompressionProfile& GetCompressionProfile(const FString& ModName) const;
+
+	/**
+	 * Cooked platforms every mod is packaged for, e.g. WindowsNoEditor and LinuxServer. The platforms are cooked
+	 * concurrently. If empty, mods are packaged for the platform the editor runs on.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Platforms")
+	TArray<FString> TargetPlatforms;
+
+	/** Compression profile of every mod without a profile of its own */
+	UPROPERTY(config, EditAnywhere, Category = "Compression")
+	FModCompressionProfile DefaultCompressionProfile;
+
+	/** Compression profiles of individual mods, by mod name */
+	UPROPERTY(config, EditAnywhere, Category = "Compression")
+	TMap<FString, FModCompressionProfile> ModCompressionProfiles;
+
+	/** Compression formats tried by the compression benchmark */
+	UPROPERTY(config, EditAnywhere, Category = "Compression Benchmark")
+	TArray<FName> BenchmarkCompressionFormats;
+
+	/** Compression block sizes tried by the compression benchmark */
+	UPROPERTY(config, EditAnywhere, Category = "Compression Benchmark")
+	TArray<int32> BenchmarkCompressionBlockSizes;
+
+	/** Maximum number of bytes of cooked assets the compression benchmark samples from a mod, picked at random from all of its files */
+	UPROPERTY(config, EditAnywhere, Category = "Compression Benchmark")
+	int32 BenchmarkSampleSize;
+
+	/** Split large mods into a core pak that is always mounted and optional chunks that are mounted on demand */
+	UPROPERTY(config, EditAnywhere, Category = "Chunking")
+	bool bEnableChunking;
+
+	/** Mods with less content than this, in megabytes, are always packaged into a single pak */
+	UPROPERTY(config, EditAnywhere, Category = "Chunking", meta = (ClampMin = "1", EditCondition = "bEnableChunking"))
+	int32 MinChunkingSizeMB;
+
+	/** Size optional chunks are filled up to, in megabytes. A cluster of packages bigger than this gets a chunk of its own */
+	UPROPERTY(config, EditAnywhere, Category = "Chunking", meta = (ClampMin = "1", EditCondition = "bEnableChunking"))
+	int32 TargetChunkSizeMB;
+
+	/** Cook the shaders of every mod into a shared shader library that ships in the mod's pak and is opened when the mod is mounted */
+	UPROPERTY(config, EditAnywhere, Category = "Shaders")
+	bool bPackageShaderLibrary;
+
+	/**
+	 * Check the references of a mod before packaging it from the editor, and ask before packaging a mod that references
+	 * content it can't rely on at runtime, like a mod it doesn't require. See FModReferenceValidator.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Validation")
+	bool bValidateReferences;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A reference from a package of a mod to a package the mod can't rely on at runtime */
+struct FModReferenceViolation
+{
+	FString ModName;
+
+	/** The package of the mod holding the reference */
+	FName Referencer;
+
+	/** The referenced package */
+	FName Dependency;
+
+	/** Why the reference isn't allowed */
+	FString Reason;
+
+	/** Soft references only load their dependency once it is resolved, so they are reported without failing the mod */
+	bool bSoft = false;
+};
+
+/**
+ * Finds references that leave the content a mod can rely on at runtime. A mod may reference its own content, the
+ * game, the engine, native classes, content plugins that aren't mods, and the mods it requires directly or through
+ * one of its requirements, as those are mounted before it. Anything else, like another mod that isn't required,
+ * packages fine and only fails once the mod is loaded. Only hard references fail a mod, soft references that leave
+ * the allowed content are reported as warnings.
+ *
+ * The dependencies of every package are cached per mod and only read again from the asset registry for packages
+ * whose file changed, so validating again after a few edits only rescans the edited packages.
+ */
+class FModReferenceValidator
+{
+public:
+
+	/**
+	 * Validates the references of the given mods, logs every violation and writes them to Saved/ModInfo/ModReferenceViolations.json.
+	 * Mods are walked in parallel, only reading the dependencies of changed packages runs on the game thread.
+	 *
+	 * @param	Mods			The mods to validate
+	 * @param	OutViolations	Receives the hard references that leave the allowed content, ordered by mod and package
+	 * @return	The number of hard violations
+	 */
+	static int32 Run(const TArray<TSharedRef<class IPlugin>>& Mods, TArray<FModReferenceViolation>& OutViolations);
+
+	/** @return The filename of the dependency cache of a mod */
+	static FString GetCacheFilename(const FString& ModName);
+};
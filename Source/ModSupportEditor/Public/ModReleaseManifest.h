@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** The state of a single mod package at the time it was released */
+struct FModAssetRecord
+{
+	/** Hash of the package file on disk */
+	FString Hash;
+
+	/** Packages this package depends on */
+	TArray<FName> Dependencies;
+};
+
+/**
+ * Per-asset content hashes of a packaged mod, saved after every successful package so the next
+ * package only has to cook and pak what changed since.
+ */
+class FModReleaseManifest
+{
+public:
+
+	FModReleaseManifest();
+
+	/** @return The filename of the manifest describing the last release of a mod */
+	static FString GetManifestFilename(const FString& ModName);
+
+	/** Hashes every package of the mod and records its dependencies from the asset registry */
+	void Build(TSharedRef<class IPlugin> Plugin);
+
+	bool Load(const FString& Filename);
+	bool Save(const FString& Filename) const;
+
+	/**
+	 * Finds the packages that have to be packaged again compared with a previous release: new and modified
+	 * packages, and every package that directly or indirectly depends on one of them.
+	 *
+	 * @param	Previous			The manifest of the previous release
+	 * @param	OutChangedPackages	Receives the packages to package again
+	 * @return	False if packages were removed since the previous release, which requires a full package
+	 */
+	bool GetChangedPackages(const FModReleaseManifest& Previous, TArray<FName>& OutChangedPackages) const;
+
+	/** Number of incremental patches released on top of the last full package */
+	int32 PatchCount;
+
+	TMap<FName, FModAssetRecord> Assets;
+};